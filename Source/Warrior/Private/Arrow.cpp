@@ -8,10 +8,17 @@
 #include "Runtime/Engine/Classes/GameFramework/Pawn.h"
 #include "WarriorCharacter.h"
 #include "Runtime/Engine/Classes/Kismet/GameplayStatics.h"
+#include "WarriorTelemetry.h"
+#include "WarriorStreamingGrid.h"
+#include "WarriorArrowPhysicsService.h"
+#include "WarriorMemoryTracker.h"
+#include "WarriorLatencyTrace.h"
 
 // Sets default values
 AArrow::AArrow()
 {
+	WARRIOR_LLM_SCOPE(Arrows);
+
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	//PrimaryActorTick.bCanEverTick = true;
 
@@ -39,6 +46,13 @@ AArrow::AArrow()
 	// Die after 3 seconds by default
 	InitialLifeSpan = 3.0f;
 
+	// Arrows are spawned by the server only, clients see the replicated ones
+	bReplicates = true;
+	bReplicateMovement = true;
+
+	Damage = 25.f;
+	LatencyTraceId = 0;
+
 }
 
 void AArrow::DamageCustomFunction()
@@ -47,6 +61,11 @@ void AArrow::DamageCustomFunction()
 }
 
 void AArrow::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit)
+{
+	HandleHit(Hit);
+}
+
+void AArrow::HandleHit(const FHitResult& Hit)
 {
 	//damage part
 	//AWarriorCharacter* WarriorCharacter = Cast<AWarriorCharacter>(this->GetOwner());
@@ -56,6 +75,8 @@ void AArrow::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveC
 	//APlayerController* PlayerController = Cast<APlayerController>(GetController());  
 
 	GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Cyan, FString::Printf(TEXT("Arrow has made contact with: %s"), *Hit.GetActor()->GetName()));
+	FWarriorTelemetry::Record(EWarriorTelemetryEvent::ArrowHit, this, Hit.GetActor(), 0.f, Hit.ImpactPoint);
+	FWarriorLatencyTrace::Mark(LatencyTraceId, EWarriorLatencyStage::ArrowHit);
 	//GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Orange, FString::Printf(TEXT("Impact Point: %s"), *Hit.ImpactPoint.ToString()));
     //GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Magenta, FString::Printf(TEXT("Normal Point: %s"), *Hit.ImpactNormal.ToString()));
 
@@ -64,8 +85,21 @@ void AArrow::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveC
 	//Hit.GetActor()->Destroy();
 	
 
+	HandleImpact(Hit);
+
+	if (Role == ROLE_Authority && StatusEffects.Num() > 0)
+	{
+		if (AWarriorStatusEffectService* StatusEffectService = AWarriorWorldService::Get<AWarriorStatusEffectService>(this))
+		{
+			StatusEffectService->ApplyEffects(Hit.GetActor(), StatusEffects, GetInstigatorController());
+		}
+	}
+}
+
+void AArrow::HandleImpact(const FHitResult& Hit)
+{
 	TSubclassOf<class UDamageType> DamageTypeClass;
-	UGameplayStatics::ApplyDamage(Hit.GetActor(), 25.0f, NULL, this, DamageTypeClass);
+	UGameplayStatics::ApplyDamage(Hit.GetActor(), Damage, NULL, this, DamageTypeClass);
 	//GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Cyan, FString::Printf(TEXT("25.0f Damage Applied by arrow")));
 	//Hit.GetActor()->InflictDamage(25.f, DamageEvent, NULL, this);
 }
@@ -73,8 +107,33 @@ void AArrow::OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveC
 // Called when the game starts or when spawned
 void AArrow::BeginPlay()
 {
+	WARRIOR_LLM_SCOPE(Arrows);
+
 	Super::BeginPlay();
-	
+
+	FWarriorMemoryTracker::OnSpawned(EWarriorMemoryClass::Arrow, this);
+
+	// On streamed maps the grid hands the arrow over from cell to cell
+	if (Role == ROLE_Authority)
+	{
+		if (AWarriorStreamingGrid* Grid = AWarriorWorldService::Get<AWarriorStreamingGrid>(this, false))
+		{
+			Grid->RegisterArrow(this);
+		}
+
+		// Flown at a fixed rate, the projectile movement only takes over if the service is disabled
+		if (AWarriorArrowPhysicsService* ArrowPhysics = AWarriorWorldService::Get<AWarriorArrowPhysicsService>(this))
+		{
+			ArrowPhysics->RegisterArrow(this);
+		}
+	}
+}
+
+void AArrow::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWarriorMemoryTracker::OnDestroyed(EWarriorMemoryClass::Arrow, this);
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -2,15 +2,29 @@
 
 
 #include "BoxActor.h"
+#include "WarriorTelemetry.h"
+#include "WarriorMemoryTracker.h"
+#include "WarriorLatencyTrace.h"
+#include "WarriorStatusEffectService.h"
+#include "Arrow.h"
 
 // Sets default values
 ABoxActor::ABoxActor()
 {
+	WARRIOR_LLM_SCOPE(Boxes);
+
  	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
 	PrimaryActorTick.bCanEverTick = true;
 
 	BoxMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Box Mesh Text"));
 
+	// Spawned by the server, replicated to the clients
+	bReplicates = true;
+
+	// Boxes never change once replicated, only their destruction needs to reach the clients
+	NetDormancy = DORM_DormantAll;
+	NetUpdateFrequency = 2.f;
+
 	DefaultHealth = 100;
 	Health = DefaultHealth;
 	HealthPercentage = 1.0;
@@ -23,6 +37,18 @@ void ABoxActor::BeginPlay()
 {
 	Super::BeginPlay();
 	
+	FWarriorMemoryTracker::OnSpawned(EWarriorMemoryClass::Box, this);
+}
+
+void ABoxActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	FWarriorMemoryTracker::OnDestroyed(EWarriorMemoryClass::Box, this);
+	if (AWarriorStatusEffectService* StatusEffects = AWarriorWorldService::Get<AWarriorStatusEffectService>(this, false))
+	{
+		StatusEffects->ClearEffects(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 // Called every frame
@@ -41,10 +67,16 @@ float ABoxActor::TakeDamage(float DamageAmount, struct FDamageEvent const& Damag
 {
 	Health -= DamageAmount;
 	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("TakeDamage Function Called, Damage recieved"));
+	FWarriorTelemetry::Record(EWarriorTelemetryEvent::DamageApplied, DamageCauser, this, DamageAmount, GetActorLocation());
+	if (const AArrow* Arrow = Cast<AArrow>(DamageCauser))
+	{
+		FWarriorLatencyTrace::Mark(Arrow->LatencyTraceId, EWarriorLatencyStage::DamageApplied);
+	}
 
 	if (Health <= 0)
 	{
 		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::White, TEXT("Actor Destroyed"));
+		FWarriorTelemetry::Record(EWarriorTelemetryEvent::Death, DamageCauser, this, Health, GetActorLocation());
 		this->Destroy();
 	}
 	return Health;
@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "ExplosiveArrow.h"
+#include "WarriorAreaDamageService.h"
+
+AExplosiveArrow::AExplosiveArrow()
+{
+	DamageRadius = 300.f;
+	InnerRadius = 50.f;
+	MinDamageFraction = 0.2f;
+}
+
+void AExplosiveArrow::HandleImpact(const FHitResult& Hit)
+{
+	// Damage is the server's business, clients only see the arrow go
+	if (Role < ROLE_Authority)
+	{
+		return;
+	}
+
+	AWarriorAreaDamageService* AreaDamage = AWarriorWorldService::Get<AWarriorAreaDamageService>(this);
+	if (AreaDamage == nullptr)
+	{
+		Super::HandleImpact(Hit);
+		return;
+	}
+
+	FWarriorExplosion Explosion;
+	Explosion.Origin = Hit.ImpactPoint;
+	Explosion.Radius = DamageRadius;
+	Explosion.InnerRadius = InnerRadius;
+	Explosion.Damage = Damage;
+	Explosion.MinDamageFraction = MinDamageFraction;
+	Explosion.Causer = this;
+	Explosion.Instigator = GetInstigatorController();
+	Explosion.IgnoreActor = GetOwner();
+	AreaDamage->QueueExplosion(Explosion);
+}
@@ -0,0 +1,227 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorAimService.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "Arrow.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Aim Tick"), STAT_WarriorAimTick, STATGROUP_Warrior);
+DECLARE_CYCLE_STAT(TEXT("Aim Batch Solve"), STAT_WarriorAimSolve, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aim Shots"), STAT_WarriorAimShots, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Aim Fallbacks"), STAT_WarriorAimFallbacks, STATGROUP_Warrior);
+
+namespace WarriorAim
+{
+	/** The closed form is only trusted while the target is clearly slower than the arrow, |v|^2 < (1 - MinSpeedMargin) s^2 */
+	static const float MinSpeedMargin = 0.01f;
+
+	/** Padding lanes and arrows without a lifespan */
+	static const float NoTimeLimit = 1.e9f;
+}
+
+AWarriorAimService::AWarriorAimService()
+{
+	// After the timers, so volley shots queued this frame are fired this frame
+	PrimaryActorTick.TickGroup = TG_PostUpdateWork;
+
+	bLeadTargets = true;
+	GravityPasses = 2;
+	MaxFallbackIterations = 8;
+	FallbackTolerance = 0.001f;
+}
+
+void AWarriorAimService::QueueShot(AWarriorCombatCharacter* Shooter, AActor* Target, const FVector& SpawnLocation)
+{
+	if (Shooter == nullptr)
+	{
+		return;
+	}
+
+	FShot& Shot = PendingShots.AddDefaulted_GetRef();
+	Shot.Shooter = Shooter;
+	Shot.Target = Target;
+	Shot.SpawnLocation = SpawnLocation;
+}
+
+bool AWarriorAimService::SolveIterative(const FVector& Delta, const FVector& TargetVelocity, float ArrowSpeed, float ArrowGravityZ, float FlightLimit, FVector& OutAim) const
+{
+	// Fixed point on the flight time: t = |D + V t - g t^2 / 2| / s
+	float Time = Delta.Size() / ArrowSpeed;
+	for (int32 Iteration = 0; Iteration < MaxFallbackIterations && Time <= FlightLimit; ++Iteration)
+	{
+		const FVector Aim = Delta + TargetVelocity * Time - FVector(0.f, 0.f, 0.5f * ArrowGravityZ * Time * Time);
+		const float NewTime = Aim.Size() / ArrowSpeed;
+		if (FMath::Abs(NewTime - Time) < FallbackTolerance)
+		{
+			if (NewTime > FlightLimit)
+			{
+				break;
+			}
+			OutAim = Aim;
+			return true;
+		}
+		Time = NewTime;
+	}
+
+	// Out of reach, at least compensate the drop to where the target is now
+	Time = Delta.Size() / ArrowSpeed;
+	OutAim = Delta - FVector(0.f, 0.f, 0.5f * ArrowGravityZ * Time * Time);
+	return false;
+}
+
+void AWarriorAimService::SolveBatch(int32 NumLanes)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorAimSolve);
+
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister Half = VectorSetFloat1(0.5f);
+	const VectorRegister MinNegA = VectorSetFloat1(WarriorAim::MinSpeedMargin);
+	const VectorRegister Tiny = VectorSetFloat1(SMALL_NUMBER);
+
+	FallbackMasks.SetNumUninitialized(NumLanes / 4);
+
+	for (int32 Lane = 0; Lane < NumLanes; Lane += 4)
+	{
+		const VectorRegister DX = VectorLoadAligned(&DeltaX[Lane]);
+		const VectorRegister DY = VectorLoadAligned(&DeltaY[Lane]);
+		const VectorRegister DZ = VectorLoadAligned(&DeltaZ[Lane]);
+		const VectorRegister VX = VectorLoadAligned(&VelX[Lane]);
+		const VectorRegister VY = VectorLoadAligned(&VelY[Lane]);
+		const VectorRegister VZ = VectorLoadAligned(&VelZ[Lane]);
+		const VectorRegister S = VectorLoadAligned(&Speed[Lane]);
+		const VectorRegister G = VectorLoadAligned(&GravityZ[Lane]);
+		const VectorRegister InvS = VectorReciprocalAccurate(S);
+		const VectorRegister SpeedSq = VectorMultiply(S, S);
+
+		// |D + V t| = s t  =>  a t^2 + 2 h t + c = 0
+		const VectorRegister A = VectorSubtract(VectorMultiplyAdd(VX, VX, VectorMultiplyAdd(VY, VY, VectorMultiply(VZ, VZ))), SpeedSq);
+		const VectorRegister H = VectorMultiplyAdd(DX, VX, VectorMultiplyAdd(DY, VY, VectorMultiply(DZ, VZ)));
+		const VectorRegister C = VectorMultiplyAdd(DX, DX, VectorMultiplyAdd(DY, DY, VectorMultiply(DZ, DZ)));
+
+		// With a < 0 and c > 0 the roots have opposite signs, the positive one is (-h - sqrt(h^2 - a c)) / a
+		VectorRegister Valid = VectorCompareGT(VectorNegate(A), VectorMultiply(MinNegA, SpeedSq));
+		const VectorRegister SafeA = VectorSelect(Valid, A, VectorNegate(SpeedSq));
+		const VectorRegister Disc = VectorMax(VectorSubtract(VectorMultiply(H, H), VectorMultiply(SafeA, C)), Tiny);
+		const VectorRegister SqrtDisc = VectorMultiply(Disc, VectorReciprocalSqrtAccurate(Disc));
+		VectorRegister T = VectorMultiply(VectorSubtract(VectorNegate(H), SqrtDisc), VectorReciprocalAccurate(SafeA));
+
+		// Lead point, lifted by the drop over the flight time, then the flight time of that aim
+		VectorRegister AX, AY, AZ;
+		for (int32 Pass = 0; ; ++Pass)
+		{
+			AX = VectorMultiplyAdd(VX, T, DX);
+			AY = VectorMultiplyAdd(VY, T, DY);
+			AZ = VectorSubtract(VectorMultiplyAdd(VZ, T, DZ), VectorMultiply(VectorMultiply(Half, G), VectorMultiply(T, T)));
+			if (Pass >= GravityPasses)
+			{
+				break;
+			}
+			const VectorRegister LengthSq = VectorMax(VectorMultiplyAdd(AX, AX, VectorMultiplyAdd(AY, AY, VectorMultiply(AZ, AZ))), Tiny);
+			T = VectorMultiply(VectorMultiply(LengthSq, VectorReciprocalSqrtAccurate(LengthSq)), InvS);
+		}
+
+		Valid = VectorBitwiseAnd(Valid, VectorCompareGT(T, Zero));
+		Valid = VectorBitwiseAnd(Valid, VectorCompareGE(VectorLoadAligned(&MaxTime[Lane]), T));
+
+		VectorStoreAligned(AX, &AimX[Lane]);
+		VectorStoreAligned(AY, &AimY[Lane]);
+		VectorStoreAligned(AZ, &AimZ[Lane]);
+		FallbackMasks[Lane / 4] = ~VectorMaskBits(Valid) & 0xF;
+	}
+}
+
+void AWarriorAimService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorAimTick);
+
+	Super::Tick(DeltaTime);
+
+	const int32 NumShots = PendingShots.Num();
+	if (NumShots == 0)
+	{
+		return;
+	}
+	INC_DWORD_STAT_BY(STAT_WarriorAimShots, NumShots);
+
+	const int32 NumLanes = Align(NumShots, 4);
+	for (auto* Array : { &DeltaX, &DeltaY, &DeltaZ, &VelX, &VelY, &VelZ, &Speed, &GravityZ, &MaxTime, &AimX, &AimY, &AimZ })
+	{
+		Array->SetNumUninitialized(NumLanes, false);
+	}
+
+	const float WorldGravityZ = GetWorld()->GetGravityZ();
+	TBitArray<> Solvable(false, NumShots);
+	for (int32 Lane = 0; Lane < NumLanes; ++Lane)
+	{
+		// Padding and shots whose shooter or target is gone get a harmless lane, they are handled below
+		DeltaX[Lane] = 1.f;
+		DeltaY[Lane] = DeltaZ[Lane] = 0.f;
+		VelX[Lane] = VelY[Lane] = VelZ[Lane] = 0.f;
+		Speed[Lane] = 1.f;
+		GravityZ[Lane] = 0.f;
+		MaxTime[Lane] = WarriorAim::NoTimeLimit;
+
+		if (Lane >= NumShots)
+		{
+			continue;
+		}
+
+		const FShot& Shot = PendingShots[Lane];
+		AWarriorCombatCharacter* Shooter = Shot.Shooter.Get();
+		AActor* Target = Shot.Target.Get();
+		const AArrow* ArrowDefaults = (Shooter && Shooter->ProjectileClass) ? Shooter->ProjectileClass->GetDefaultObject<AArrow>() : nullptr;
+		const UProjectileMovementComponent* Movement = ArrowDefaults ? ArrowDefaults->GetProjectileMovement() : nullptr;
+		if (Target == nullptr || Movement == nullptr || Movement->InitialSpeed <= 0.f)
+		{
+			continue;
+		}
+
+		Solvable[Lane] = true;
+		const FVector Delta = Target->GetActorLocation() - Shot.SpawnLocation;
+		// Characters report the velocity of their movement component
+		const FVector Velocity = bLeadTargets ? Target->GetVelocity() : FVector::ZeroVector;
+		DeltaX[Lane] = Delta.X;
+		DeltaY[Lane] = Delta.Y;
+		DeltaZ[Lane] = Delta.Z;
+		VelX[Lane] = Velocity.X;
+		VelY[Lane] = Velocity.Y;
+		VelZ[Lane] = Velocity.Z;
+		Speed[Lane] = Movement->InitialSpeed;
+		GravityZ[Lane] = WorldGravityZ * Movement->ProjectileGravityScale;
+		MaxTime[Lane] = ArrowDefaults->InitialLifeSpan > 0.f ? ArrowDefaults->InitialLifeSpan : WarriorAim::NoTimeLimit;
+	}
+
+	SolveBatch(NumLanes);
+
+	int32 NumFallbacks = 0;
+	for (int32 Lane = 0; Lane < NumShots; ++Lane)
+	{
+		const FShot& Shot = PendingShots[Lane];
+		AWarriorCombatCharacter* Shooter = Shot.Shooter.Get();
+		if (Shooter == nullptr || Shooter->IsPendingKill())
+		{
+			continue;
+		}
+
+		if (!Solvable[Lane])
+		{
+			Shooter->SpawnArrow(Shot.SpawnLocation, Shooter->GetAimRotation(Shot.SpawnLocation));
+			continue;
+		}
+
+		FVector Aim(AimX[Lane], AimY[Lane], AimZ[Lane]);
+		if (FallbackMasks[Lane / 4] & (1 << (Lane & 3)))
+		{
+			++NumFallbacks;
+			SolveIterative(FVector(DeltaX[Lane], DeltaY[Lane], DeltaZ[Lane]), FVector(VelX[Lane], VelY[Lane], VelZ[Lane]), Speed[Lane], GravityZ[Lane], MaxTime[Lane], Aim);
+		}
+
+		Shooter->SpawnArrow(Shot.SpawnLocation, Aim.Rotation());
+	}
+	INC_DWORD_STAT_BY(STAT_WarriorAimFallbacks, NumFallbacks);
+
+	PendingShots.Reset();
+}
@@ -0,0 +1,202 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorAreaDamageService.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "BoxActor.h"
+#include "Components/PrimitiveComponent.h"
+#include "Engine/World.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+
+DECLARE_CYCLE_STAT(TEXT("Area Damage Tick"), STAT_WarriorAreaDamageTick, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Explosions"), STAT_WarriorAreaDamageExplosions, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Queries"), STAT_WarriorAreaDamageQueries, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Area Damage Victims"), STAT_WarriorAreaDamageVictims, STATGROUP_Warrior);
+
+AWarriorAreaDamageService::AWarriorAreaDamageService()
+{
+	// Arrows hit while their movement ticks, everything of the frame is in by then
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	MaxClusterRadius = 2000.f;
+}
+
+void AWarriorAreaDamageService::QueueExplosion(const FWarriorExplosion& Explosion)
+{
+	if (Explosion.Radius > 0.f && Explosion.Damage > 0.f)
+	{
+		PendingExplosions.Add(Explosion);
+	}
+}
+
+float AWarriorAreaDamageService::GetFalloffDamage(const FWarriorExplosion& Explosion, float Distance)
+{
+	if (Distance >= Explosion.Radius)
+	{
+		return 0.f;
+	}
+	if (Distance <= Explosion.InnerRadius)
+	{
+		return Explosion.Damage;
+	}
+
+	const float Alpha = (Distance - Explosion.InnerRadius) / FMath::Max(Explosion.Radius - Explosion.InnerRadius, KINDA_SMALL_NUMBER);
+	return Explosion.Damage * FMath::Lerp(1.f, Explosion.MinDamageFraction, Alpha);
+}
+
+void AWarriorAreaDamageService::BuildClusters(TArray<FCluster>& OutClusters) const
+{
+	for (int32 Index = 0; Index < PendingExplosions.Num(); ++Index)
+	{
+		const FWarriorExplosion& Explosion = PendingExplosions[Index];
+
+		bool bMerged = false;
+		for (FCluster& Cluster : OutClusters)
+		{
+			const float Distance = FVector::Dist(Cluster.Center, Explosion.Origin);
+			if (Distance > Cluster.Radius + Explosion.Radius)
+			{
+				continue;
+			}
+
+			// Smallest sphere holding the cluster and the explosion
+			if (Distance + Explosion.Radius > Cluster.Radius)
+			{
+				const float MergedRadius = 0.5f * (Cluster.Radius + Distance + Explosion.Radius);
+				if (MergedRadius > MaxClusterRadius)
+				{
+					continue;
+				}
+				if (Distance > KINDA_SMALL_NUMBER)
+				{
+					Cluster.Center += (Explosion.Origin - Cluster.Center) * ((MergedRadius - Cluster.Radius) / Distance);
+				}
+				Cluster.Radius = MergedRadius;
+			}
+			Cluster.Explosions.Add(Index);
+			bMerged = true;
+			break;
+		}
+
+		if (!bMerged)
+		{
+			FCluster& Cluster = OutClusters.AddDefaulted_GetRef();
+			Cluster.Explosions.Add(Index);
+			Cluster.Center = Explosion.Origin;
+			Cluster.Radius = Explosion.Radius;
+		}
+	}
+}
+
+void AWarriorAreaDamageService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorAreaDamageTick);
+
+	Super::Tick(DeltaTime);
+
+	if (PendingExplosions.Num() == 0)
+	{
+		return;
+	}
+	INC_DWORD_STAT_BY(STAT_WarriorAreaDamageExplosions, PendingExplosions.Num());
+
+	TArray<FCluster> Clusters;
+	BuildClusters(Clusters);
+	INC_DWORD_STAT_BY(STAT_WarriorAreaDamageQueries, Clusters.Num());
+
+	struct FVictim
+	{
+		float Damage = 0.f;
+		/** Of the explosion that dealt the most, the arrows are already pending kill */
+		AActor* Causer = nullptr;
+		AController* Instigator = nullptr;
+		float CauserDamage = 0.f;
+	};
+	TMap<AActor*, FVictim> Victims;
+
+	// Warriors are pawns, boxes are dynamic meshes
+	FCollisionObjectQueryParams ObjectParams;
+	ObjectParams.AddObjectTypesToQuery(ECC_Pawn);
+	ObjectParams.AddObjectTypesToQuery(ECC_WorldDynamic);
+	const FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WarriorAreaDamage), false);
+
+	TArray<FOverlapResult> Overlaps;
+	TMap<AActor*, TArray<float, TInlineAllocator<8>>> Distances;
+	for (const FCluster& Cluster : Clusters)
+	{
+		Overlaps.Reset();
+		GetWorld()->OverlapMultiByObjectType(Overlaps, Cluster.Center, FQuat::Identity, ObjectParams, FCollisionShape::MakeSphere(Cluster.Radius), QueryParams);
+
+		// Closest distance of each actor to each explosion of the cluster, over all its components found
+		Distances.Reset();
+		for (const FOverlapResult& Overlap : Overlaps)
+		{
+			AActor* Actor = Overlap.GetActor();
+			UPrimitiveComponent* Component = Overlap.GetComponent();
+			if (Actor == nullptr || Component == nullptr || Actor->IsPendingKill() || !(Actor->IsA<AWarriorCombatCharacter>() || Actor->IsA<ABoxActor>()))
+			{
+				continue;
+			}
+
+			// A warrior is measured from its capsule, not from the detection sphere around it
+			if (Actor->IsA<AWarriorCombatCharacter>() && Component != Actor->GetRootComponent())
+			{
+				continue;
+			}
+
+			TArray<float, TInlineAllocator<8>>& ActorDistances = Distances.FindOrAdd(Actor);
+			if (ActorDistances.Num() == 0)
+			{
+				ActorDistances.Init(MAX_flt, Cluster.Explosions.Num());
+			}
+			const FBox Bounds = Component->Bounds.GetBox();
+			for (int32 Slot = 0; Slot < Cluster.Explosions.Num(); ++Slot)
+			{
+				const float DistanceSq = Bounds.ComputeSquaredDistanceToPoint(PendingExplosions[Cluster.Explosions[Slot]].Origin);
+				ActorDistances[Slot] = FMath::Min(ActorDistances[Slot], DistanceSq);
+			}
+		}
+
+		for (const TPair<AActor*, TArray<float, TInlineAllocator<8>>>& Pair : Distances)
+		{
+			for (int32 Slot = 0; Slot < Cluster.Explosions.Num(); ++Slot)
+			{
+				const FWarriorExplosion& Explosion = PendingExplosions[Cluster.Explosions[Slot]];
+				if (Explosion.IgnoreActor.Get(true) == Pair.Key)
+				{
+					continue;
+				}
+
+				const float Damage = GetFalloffDamage(Explosion, FMath::Sqrt(Pair.Value[Slot]));
+				if (Damage <= 0.f)
+				{
+					continue;
+				}
+
+				FVictim& Victim = Victims.FindOrAdd(Pair.Key);
+				Victim.Damage += Damage;
+				if (Damage > Victim.CauserDamage)
+				{
+					Victim.CauserDamage = Damage;
+					Victim.Causer = Explosion.Causer.Get(true);
+					Victim.Instigator = Explosion.Instigator.Get();
+				}
+			}
+		}
+	}
+
+	// Cleared before applying, anything TakeDamage queues is for the next frame
+	PendingExplosions.Reset();
+
+	INC_DWORD_STAT_BY(STAT_WarriorAreaDamageVictims, Victims.Num());
+	const FDamageEvent DamageEvent(UDamageType::StaticClass());
+	for (const TPair<AActor*, FVictim>& Pair : Victims)
+	{
+		if (!Pair.Key->IsPendingKill())
+		{
+			Pair.Key->TakeDamage(Pair.Value.Damage, DamageEvent, Pair.Value.Instigator, Pair.Value.Causer);
+		}
+	}
+}
@@ -0,0 +1,170 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorArenaBenchmarkCommandlet.h"
+#include "Warrior.h"
+#include "WarriorProcessUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UWarriorArenaBenchmarkCommandlet::UWarriorArenaBenchmarkCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UWarriorArenaBenchmarkCommandlet::Main(const FString& Params)
+{
+	FString Map;
+	if (!FParse::Value(*Params, TEXT("Map="), Map))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorArenaBenchmark: -Map= is required"));
+		return 1;
+	}
+
+	int32 NumArenas = 16;
+	int32 PlayersPerArena = 8;
+	int32 Port = 7777;
+	float Seconds = 60.f;
+	float WarmupSeconds = 15.f;
+	float ServerStartupSeconds = 20.f;
+	FString Behavior = TEXT("Random");
+	FParse::Value(*Params, TEXT("Arenas="), NumArenas);
+	FParse::Value(*Params, TEXT("PlayersPerArena="), PlayersPerArena);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+	FParse::Value(*Params, TEXT("WarmupSeconds="), WarmupSeconds);
+	FParse::Value(*Params, TEXT("ServerStartupSeconds="), ServerStartupSeconds);
+	FParse::Value(*Params, TEXT("Behavior="), Behavior);
+	NumArenas = FMath::Max(NumArenas, 1);
+	PlayersPerArena = FMath::Max(PlayersPerArena, 1);
+
+	const FString ProjectFile = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	const FString CsvPrefix = FPaths::ConvertRelativePathToFull(FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorArenaBenchmark-%s"), *FDateTime::Now().ToString()));
+
+	auto LaunchServer = [&](int32 ServerPort, int32 Arenas, const FString& CsvPath)
+	{
+		return WarriorProcessUtils::Launch(FString::Printf(
+			TEXT("\"%s\" %s?MaxPlayers=%d -server -nullrhi -nosound -unattended -log -port=%d -WarriorArenas=%d -WarriorLoadTest -WarriorLoadCsv=\"%s\" -WarriorLoadInterval=5"),
+			*ProjectFile, *Map, Arenas * PlayersPerArena, ServerPort, Arenas, *CsvPath));
+	};
+	auto LaunchBots = [&](int32 ServerPort, int32 Seed)
+	{
+		return WarriorProcessUtils::Launch(FString::Printf(
+			TEXT("\"%s\" 127.0.0.1:%d -game -nullrhi -nosound -unattended -WarriorBots=%d -WarriorBotBehavior=%s -WarriorBotSeed=%d"),
+			*ProjectFile, ServerPort, PlayersPerArena, *Behavior, Seed));
+	};
+
+	// The map without any arena or player, what every process costs before its arenas
+	const FString BaselineCsv = CsvPrefix + TEXT("-Baseline.csv");
+	{
+		TArray<FProcHandle> Processes;
+		Processes.Add(LaunchServer(Port, 0, BaselineCsv));
+		UE_LOG(LogWarrior, Display, TEXT("WarriorArenaBenchmark: empty server, measuring for %.0fs"), ServerStartupSeconds + Seconds);
+		FPlatformProcess::Sleep(ServerStartupSeconds + Seconds);
+		WarriorProcessUtils::Terminate(Processes);
+	}
+
+	// One process hosting every arena, one bot process filling each arena
+	const FString SharedCsv = CsvPrefix + TEXT("-Shared.csv");
+	{
+		TArray<FProcHandle> Processes;
+		Processes.Add(LaunchServer(Port, NumArenas, SharedCsv));
+		FPlatformProcess::Sleep(ServerStartupSeconds);
+		for (int32 Index = 0; Index < NumArenas; ++Index)
+		{
+			Processes.Add(LaunchBots(Port, Index));
+		}
+		UE_LOG(LogWarrior, Display, TEXT("WarriorArenaBenchmark: %d arenas in one process, measuring for %.0fs"), NumArenas, Seconds);
+		FPlatformProcess::Sleep(Seconds);
+		WarriorProcessUtils::Terminate(Processes);
+	}
+
+	// One process per arena
+	TArray<FString> SeparateCsvs;
+	{
+		TArray<FProcHandle> Processes;
+		for (int32 Index = 0; Index < NumArenas; ++Index)
+		{
+			SeparateCsvs.Add(CsvPrefix + FString::Printf(TEXT("-Process%d.csv"), Index));
+			Processes.Add(LaunchServer(Port + 1 + Index, 1, SeparateCsvs.Last()));
+		}
+		FPlatformProcess::Sleep(ServerStartupSeconds);
+		for (int32 Index = 0; Index < NumArenas; ++Index)
+		{
+			Processes.Add(LaunchBots(Port + 1 + Index, Index));
+		}
+		UE_LOG(LogWarrior, Display, TEXT("WarriorArenaBenchmark: %d processes with one arena each, measuring for %.0fs"), NumArenas, Seconds);
+		FPlatformProcess::Sleep(Seconds);
+		WarriorProcessUtils::Terminate(Processes);
+	}
+
+	const FServerSample Baseline = ReadSamples(BaselineCsv, WarmupSeconds);
+	const FServerSample Shared = ReadSamples(SharedCsv, WarmupSeconds);
+	FServerSample Separate;
+	int32 NumSeparate = 0;
+	for (const FString& CsvPath : SeparateCsvs)
+	{
+		const FServerSample Sample = ReadSamples(CsvPath, WarmupSeconds);
+		if (Sample.NumRows > 0)
+		{
+			// Memory and game thread time add up over processes, frame time is averaged
+			Separate.UsedMB += Sample.UsedMB;
+			Separate.GameTickMs += Sample.GameTickMs;
+			Separate.FrameMs += Sample.FrameMs;
+			++NumSeparate;
+		}
+	}
+	if (Baseline.NumRows == 0 || Shared.NumRows == 0 || NumSeparate == 0)
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorArenaBenchmark: missing samples in %s*"), *CsvPrefix);
+		return 1;
+	}
+	Separate.FrameMs /= NumSeparate;
+
+	UE_LOG(LogWarrior, Display, TEXT("%d arenas, %d players each (samples in %s*)"), NumArenas, PlayersPerArena, *CsvPrefix);
+	// Memory per arena is what the arenas add over the empty server, each separate process pays the baseline once
+	UE_LOG(LogWarrior, Display, TEXT("Hosting      Processes  UsedMB  MBPerArena  FrameMs  GameTickMs  GameTickMsPerArena"));
+	UE_LOG(LogWarrior, Display, TEXT("Empty        %9d  %6.0f  %10s  %7.2f  %10.2f  %18s"),
+		1, Baseline.UsedMB, TEXT("-"), Baseline.FrameMs, Baseline.GameTickMs, TEXT("-"));
+	UE_LOG(LogWarrior, Display, TEXT("Shared       %9d  %6.0f  %10.1f  %7.2f  %10.2f  %18.3f"),
+		1, Shared.UsedMB, (Shared.UsedMB - Baseline.UsedMB) / NumArenas, Shared.FrameMs, Shared.GameTickMs, Shared.GameTickMs / NumArenas);
+	UE_LOG(LogWarrior, Display, TEXT("Separate     %9d  %6.0f  %10.1f  %7.2f  %10.2f  %18.3f"),
+		NumSeparate, Separate.UsedMB, (Separate.UsedMB - Baseline.UsedMB * NumSeparate) / NumSeparate, Separate.FrameMs, Separate.GameTickMs, Separate.GameTickMs / NumSeparate);
+	return 0;
+}
+
+UWarriorArenaBenchmarkCommandlet::FServerSample UWarriorArenaBenchmarkCommandlet::ReadSamples(const FString& CsvPath, float WarmupSeconds)
+{
+	FServerSample Sample;
+
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *CsvPath))
+	{
+		return Sample;
+	}
+
+	// Columns as written by FWarriorServerLoadStats
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		TArray<FString> Columns;
+		if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) < 12 || FCString::Atof(*Columns[0]) < WarmupSeconds)
+		{
+			continue;
+		}
+		++Sample.NumRows;
+		Sample.FrameMs += FCString::Atod(*Columns[3]);
+		Sample.GameTickMs += FCString::Atod(*Columns[5]);
+		Sample.UsedMB += FCString::Atod(*Columns[11]);
+	}
+
+	if (Sample.NumRows > 0)
+	{
+		Sample.FrameMs /= Sample.NumRows;
+		Sample.GameTickMs /= Sample.NumRows;
+		Sample.UsedMB /= Sample.NumRows;
+	}
+	return Sample;
+}
@@ -0,0 +1,360 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorArenaManager.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "Engine/Level.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerStart.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/PackageName.h"
+
+DECLARE_CYCLE_STAT(TEXT("Arena Manager Tick"), STAT_WarriorArenaTick, STATGROUP_Warrior);
+
+AWarriorArenaManager::AWarriorArenaManager()
+{
+	ArenaLevel = TEXT("/Game/Arenas/Arena");
+	// 1km apart, arenas are 4v4 maps of a couple hundred meters
+	ArenaSpacing = 100000.f;
+	ArenaColumns = 4;
+	PlayersPerArena = 8;
+	MinPlayersToStart = 2;
+	MatchDuration = 300.f;
+	RestartDelay = 10.f;
+
+	BaselineUsedPhysical = 0;
+}
+
+void AWarriorArenaManager::StartArenas(int32 Count)
+{
+	if (!FPackageName::DoesPackageExist(ArenaLevel))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("Arenas: level %s does not exist"), *ArenaLevel);
+		return;
+	}
+
+	// What the server costs without any arena, so the report only charges the arenas for what they add
+	BaselineUsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+
+	const int32 Columns = FMath::Max(ArenaColumns, 1);
+	for (int32 Index = 0; Index < Count; ++Index)
+	{
+		FArena& Arena = Arenas[Arenas.AddDefaulted()];
+		Arena.Origin = GetActorLocation() + FVector((Index % Columns) * ArenaSpacing, (Index / Columns) * ArenaSpacing, 0.f);
+
+		bool bSuccess = false;
+		Arena.Level = ULevelStreamingDynamic::LoadLevelInstance(this, ArenaLevel, Arena.Origin, FRotator::ZeroRotator, bSuccess);
+		if (bSuccess && Arena.Level)
+		{
+			ArenaLevels.Add(Arena.Level);
+		}
+		else
+		{
+			UE_LOG(LogWarrior, Error, TEXT("Arenas: could not load arena %d"), Index);
+			Arena.Level = nullptr;
+		}
+	}
+
+	UE_LOG(LogWarrior, Log, TEXT("Arenas: loading %d instances of %s"), Count, *ArenaLevel);
+}
+
+int32 AWarriorArenaManager::GetArenaAt(const FVector& Location) const
+{
+	const FVector Local = Location - GetActorLocation();
+	const int32 Column = FMath::FloorToInt(Local.X / ArenaSpacing + 0.5f);
+	const int32 Row = FMath::FloorToInt(Local.Y / ArenaSpacing + 0.5f);
+	const int32 Columns = FMath::Max(ArenaColumns, 1);
+	if (Column < 0 || Row < 0 || Column >= Columns)
+	{
+		return INDEX_NONE;
+	}
+	const int32 Index = Row * Columns + Column;
+	return Arenas.IsValidIndex(Index) ? Index : INDEX_NONE;
+}
+
+bool AWarriorArenaManager::GetArenaFrame(const FVector& Location, FVector& OutOrigin, ULevel*& OutLevel) const
+{
+	const int32 ArenaIndex = GetArenaAt(Location);
+	const FArena* Arena = Arenas.IsValidIndex(ArenaIndex) ? &Arenas[ArenaIndex] : nullptr;
+	ULevel* Level = Arena && Arena->Level ? Arena->Level->GetLoadedLevel() : nullptr;
+	if (Level == nullptr)
+	{
+		return false;
+	}
+
+	OutOrigin = Arena->Origin;
+	OutLevel = Level;
+	return true;
+}
+
+int32 AWarriorArenaManager::AssignPlayer(AController* Player)
+{
+	const int32 Current = GetPlayerArena(Player);
+	if (Current != INDEX_NONE)
+	{
+		return Current;
+	}
+
+	int32 BestIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < Arenas.Num(); ++Index)
+	{
+		FArena& Arena = Arenas[Index];
+		Arena.Players.RemoveAll([](const TWeakObjectPtr<AController>& Other) { return !Other.IsValid(); });
+		if (Arena.Level && Arena.Players.Num() < PlayersPerArena
+			&& (BestIndex == INDEX_NONE || Arena.Players.Num() < Arenas[BestIndex].Players.Num()))
+		{
+			BestIndex = Index;
+		}
+	}
+
+	if (BestIndex != INDEX_NONE)
+	{
+		Arenas[BestIndex].Players.Add(Player);
+		UE_LOG(LogWarrior, Verbose, TEXT("Arenas: %s joins arena %d"), *GetNameSafe(Player), BestIndex);
+	}
+	return BestIndex;
+}
+
+bool AWarriorArenaManager::HasFreeSlot() const
+{
+	for (const FArena& Arena : Arenas)
+	{
+		if (Arena.Level == nullptr)
+		{
+			continue;
+		}
+
+		int32 NumPlayers = 0;
+		for (const TWeakObjectPtr<AController>& Player : Arena.Players)
+		{
+			NumPlayers += Player.IsValid() ? 1 : 0;
+		}
+		if (NumPlayers < PlayersPerArena)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+void AWarriorArenaManager::RemovePlayer(AController* Player)
+{
+	for (FArena& Arena : Arenas)
+	{
+		Arena.Players.Remove(Player);
+	}
+}
+
+int32 AWarriorArenaManager::GetPlayerArena(const AController* Player) const
+{
+	for (int32 Index = 0; Index < Arenas.Num(); ++Index)
+	{
+		for (const TWeakObjectPtr<AController>& Other : Arenas[Index].Players)
+		{
+			if (Other.Get() == Player)
+			{
+				return Index;
+			}
+		}
+	}
+	return INDEX_NONE;
+}
+
+bool AWarriorArenaManager::IsArenaReady(int32 ArenaIndex) const
+{
+	return Arenas.IsValidIndex(ArenaIndex) && Arenas[ArenaIndex].State != EArenaState::Loading;
+}
+
+AActor* AWarriorArenaManager::ChoosePlayerStart(AController* Player)
+{
+	const int32 ArenaIndex = GetPlayerArena(Player);
+	if (!IsArenaReady(ArenaIndex))
+	{
+		return nullptr;
+	}
+
+	FArena& Arena = Arenas[ArenaIndex];
+	const ULevel* Level = Arena.Level ? Arena.Level->GetLoadedLevel() : nullptr;
+	if (Level == nullptr)
+	{
+		return nullptr;
+	}
+
+	TArray<APlayerStart*, TInlineAllocator<16>> Starts;
+	for (AActor* Actor : Level->Actors)
+	{
+		if (APlayerStart* Start = Cast<APlayerStart>(Actor))
+		{
+			Starts.Add(Start);
+		}
+	}
+	if (Starts.Num() == 0)
+	{
+		return nullptr;
+	}
+	return Starts[Arena.NextPlayerStart++ % Starts.Num()];
+}
+
+void AWarriorArenaManager::OnWarriorKilled(AWarriorCombatCharacter* Victim, AActor* Killer)
+{
+	const int32 ArenaIndex = GetArenaAt(Victim->GetActorLocation());
+	if (ArenaIndex == INDEX_NONE || Arenas[ArenaIndex].State != EArenaState::InProgress)
+	{
+		return;
+	}
+
+	// The other team scores
+	++Arenas[ArenaIndex].TeamKills[Victim->Team ? 0 : 1];
+}
+
+void AWarriorArenaManager::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorArenaTick);
+
+	Super::Tick(DeltaTime);
+
+	for (int32 Index = 0; Index < Arenas.Num(); ++Index)
+	{
+		FArena& Arena = Arenas[Index];
+		Arena.StateTime += DeltaTime;
+
+		switch (Arena.State)
+		{
+		case EArenaState::Loading:
+			if (Arena.Level && Arena.Level->IsLevelVisible())
+			{
+				SetState(Index, EArenaState::WaitingForPlayers);
+				RestartPlayers(Arena);
+			}
+			break;
+
+		case EArenaState::WaitingForPlayers:
+			Arena.Players.RemoveAll([](const TWeakObjectPtr<AController>& Player) { return !Player.IsValid(); });
+			if (Arena.Players.Num() >= MinPlayersToStart)
+			{
+				SetState(Index, EArenaState::InProgress);
+			}
+			break;
+
+		case EArenaState::InProgress:
+			if (Arena.StateTime >= MatchDuration)
+			{
+				UE_LOG(LogWarrior, Log, TEXT("Arenas: match %d of arena %d over, kills %d - %d"),
+					Arena.NumMatches, Index, Arena.TeamKills[0], Arena.TeamKills[1]);
+				SetState(Index, EArenaState::Finished);
+			}
+			break;
+
+		case EArenaState::Finished:
+			if (Arena.StateTime >= RestartDelay && Arena.Level)
+			{
+				// A fresh instance brings back everything placed in the arena
+				for (const TWeakObjectPtr<AController>& Player : Arena.Players)
+				{
+					if (APawn* Pawn = Player.IsValid() ? Player->GetPawn() : nullptr)
+					{
+						Pawn->Destroy();
+					}
+				}
+				ArenaLevels.Remove(Arena.Level);
+				Arena.Level->SetShouldBeLoaded(false);
+				Arena.Level->SetShouldBeVisible(false);
+				Arena.Level->SetIsRequestingUnloadAndRemoval(true);
+
+				bool bSuccess = false;
+				Arena.Level = ULevelStreamingDynamic::LoadLevelInstance(this, ArenaLevel, Arena.Origin, FRotator::ZeroRotator, bSuccess);
+				if (bSuccess && Arena.Level)
+				{
+					ArenaLevels.Add(Arena.Level);
+				}
+				else
+				{
+					Arena.Level = nullptr;
+				}
+				SetState(Index, EArenaState::Loading);
+			}
+			break;
+		}
+	}
+}
+
+void AWarriorArenaManager::SetState(int32 ArenaIndex, EArenaState State)
+{
+	FArena& Arena = Arenas[ArenaIndex];
+	UE_LOG(LogWarrior, Verbose, TEXT("Arenas: arena %d %s -> %s"), ArenaIndex, GetStateName(Arena.State), GetStateName(State));
+
+	if (State == EArenaState::InProgress)
+	{
+		Arena.TeamKills[0] = 0;
+		Arena.TeamKills[1] = 0;
+		++Arena.NumMatches;
+	}
+	Arena.State = State;
+	Arena.StateTime = 0.f;
+}
+
+void AWarriorArenaManager::RestartPlayers(FArena& Arena)
+{
+	AGameModeBase* GameMode = GetWorld()->GetAuthGameMode();
+	if (GameMode == nullptr)
+	{
+		return;
+	}
+
+	for (const TWeakObjectPtr<AController>& Player : Arena.Players)
+	{
+		if (Player.IsValid() && Player->GetPawn() == nullptr)
+		{
+			GameMode->RestartPlayer(Player.Get());
+		}
+	}
+}
+
+const TCHAR* AWarriorArenaManager::GetStateName(EArenaState State)
+{
+	switch (State)
+	{
+	case EArenaState::Loading: return TEXT("Loading");
+	case EArenaState::WaitingForPlayers: return TEXT("WaitingForPlayers");
+	case EArenaState::InProgress: return TEXT("InProgress");
+	case EArenaState::Finished: return TEXT("Finished");
+	}
+	return TEXT("Unknown");
+}
+
+void AWarriorArenaManager::DumpStats() const
+{
+	const FPlatformMemoryStats Memory = FPlatformMemory::GetStats();
+	const double UsedMB = Memory.UsedPhysical / (1024.0 * 1024.0);
+	const double BaselineMB = BaselineUsedPhysical / (1024.0 * 1024.0);
+
+	UE_LOG(LogWarrior, Log, TEXT("Arenas: %d instances of %s, %.0fMB used, %.0fMB before the arenas, %.1fMB per arena"),
+		Arenas.Num(), *ArenaLevel, UsedMB, BaselineMB, Arenas.Num() > 0 ? (UsedMB - BaselineMB) / Arenas.Num() : 0.0);
+	for (int32 Index = 0; Index < Arenas.Num(); ++Index)
+	{
+		const FArena& Arena = Arenas[Index];
+		const ULevel* Level = Arena.Level ? Arena.Level->GetLoadedLevel() : nullptr;
+		UE_LOG(LogWarrior, Log, TEXT("  %2d %-18s players %d/%d  kills %d - %d  matches %d  actors %d"),
+			Index, GetStateName(Arena.State), Arena.Players.Num(), PlayersPerArena,
+			Arena.TeamKills[0], Arena.TeamKills[1], Arena.NumMatches, Level ? Level->Actors.Num() : 0);
+	}
+}
+
+static FAutoConsoleCommandWithWorld WarriorArenaStatsCommand(
+	TEXT("Warrior.Arenas.Stats"),
+	TEXT("Prints the state, players, score and memory of every arena hosted by this server"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (AWarriorArenaManager* Arenas = AWarriorWorldService::Get<AWarriorArenaManager>(World, false))
+		{
+			Arenas->DumpStats();
+		}
+		else
+		{
+			UE_LOG(LogWarrior, Log, TEXT("Arenas: this server hosts a single match"));
+		}
+	}));
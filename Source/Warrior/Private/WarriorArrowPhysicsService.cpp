@@ -0,0 +1,177 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorArrowPhysicsService.h"
+#include "Warrior.h"
+#include "Arrow.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+
+DECLARE_CYCLE_STAT(TEXT("Arrow Physics Tick"), STAT_WarriorArrowPhysicsTick, STATGROUP_Warrior);
+DECLARE_CYCLE_STAT(TEXT("Arrow Physics Hits"), STAT_WarriorArrowPhysicsHits, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Arrow Physics Steps"), STAT_WarriorArrowPhysicsSteps, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Arrow Physics Sweeps"), STAT_WarriorArrowPhysicsSweeps, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Arrow Physics Dropped Steps"), STAT_WarriorArrowPhysicsDroppedSteps, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Simulated Arrows"), STAT_WarriorSimulatedArrows, STATGROUP_Warrior);
+
+AWarriorArrowPhysicsService::AWarriorArrowPhysicsService()
+{
+	// Hits are dispatched before physics, so the area damage and status effects of the frame see them
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	bEnabled = true;
+	StepRate = 60.f;
+	MaxStepsPerFrame = 8;
+	Accumulator = 0.f;
+}
+
+bool AWarriorArrowPhysicsService::RegisterArrow(AArrow* Arrow)
+{
+	UProjectileMovementComponent* Movement = Arrow ? Arrow->GetProjectileMovement() : nullptr;
+	if (!bEnabled || Movement == nullptr || StepRate <= 0.f)
+	{
+		return false;
+	}
+
+	// The movement component set the launch velocity when it was initialized
+	FSimulatedArrow& Simulated = Arrows.AddDefaulted_GetRef();
+	Simulated.Arrow = Arrow;
+	Simulated.Location = Simulated.PreviousLocation = Arrow->GetActorLocation();
+	Simulated.Velocity = Movement->Velocity;
+	Simulated.GravityZ = Movement->ShouldApplyGravity() ? Movement->GetGravityZ() : 0.f;
+	Simulated.MaxSpeed = Movement->GetMaxSpeed();
+	Simulated.Radius = Arrow->GetCollisionComp()->GetScaledSphereRadius();
+
+	Movement->StopMovementImmediately();
+	Movement->Deactivate();
+	Movement->Velocity = Simulated.Velocity;
+	return true;
+}
+
+void AWarriorArrowPhysicsService::Step(FSimulatedArrow& Simulated, float StepTime)
+{
+	// Same integration as the projectile movement: v t + a t^2 / 2
+	FVector NewVelocity = Simulated.Velocity + FVector(0.f, 0.f, Simulated.GravityZ * StepTime);
+	if (Simulated.MaxSpeed > 0.f)
+	{
+		NewVelocity = NewVelocity.GetClampedToMaxSize(Simulated.MaxSpeed);
+	}
+
+	Simulated.PreviousLocation = Simulated.Location;
+	Simulated.Location += 0.5f * (Simulated.Velocity + NewVelocity) * StepTime;
+	Simulated.Velocity = NewVelocity;
+}
+
+bool AWarriorArrowPhysicsService::FindFirstHit(const FSimulatedArrow& Simulated, FHitResult& OutHit) const
+{
+	FTraceDatum Datum;
+	for (const FTraceHandle& Sweep : Simulated.Sweeps)
+	{
+		if (!GetWorld()->QueryTraceData(Sweep, Datum))
+		{
+			continue;
+		}
+
+		for (const FHitResult& Hit : Datum.OutHits)
+		{
+			if (Hit.bBlockingHit)
+			{
+				OutHit = Hit;
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+void AWarriorArrowPhysicsService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorArrowPhysicsTick);
+
+	Super::Tick(DeltaTime);
+
+	if (Arrows.Num() == 0)
+	{
+		Accumulator = 0.f;
+		return;
+	}
+
+	// Sweeps of last frame's steps first, the arrows that hit are gone before stepping
+	TArray<TPair<AArrow*, FHitResult>> Hits;
+	for (int32 Index = Arrows.Num() - 1; Index >= 0; --Index)
+	{
+		FSimulatedArrow& Simulated = Arrows[Index];
+		AArrow* Arrow = Simulated.Arrow.Get();
+		if (Arrow == nullptr || Arrow->IsPendingKill())
+		{
+			Arrows.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		FHitResult Hit;
+		const bool bHit = FindFirstHit(Simulated, Hit);
+		Simulated.Sweeps.Reset();
+		if (bHit)
+		{
+			Hits.Emplace(Arrow, Hit);
+			Arrows.RemoveAtSwap(Index, 1, false);
+		}
+	}
+
+	{
+		SCOPE_CYCLE_COUNTER(STAT_WarriorArrowPhysicsHits);
+
+		for (TPair<AArrow*, FHitResult>& Pair : Hits)
+		{
+			if (!Pair.Key->IsPendingKill())
+			{
+				Pair.Key->SetActorLocation(Pair.Value.Location, false, nullptr, ETeleportType::TeleportPhysics);
+				Pair.Key->HandleHit(Pair.Value);
+			}
+		}
+	}
+
+	const float StepTime = 1.f / StepRate;
+	Accumulator += DeltaTime;
+	int32 NumSteps = FMath::FloorToInt(Accumulator / StepTime);
+	if (NumSteps > MaxStepsPerFrame)
+	{
+		INC_DWORD_STAT_BY(STAT_WarriorArrowPhysicsDroppedSteps, NumSteps - MaxStepsPerFrame);
+		NumSteps = MaxStepsPerFrame;
+		Accumulator = NumSteps * StepTime;
+	}
+	Accumulator = FMath::Max(Accumulator - NumSteps * StepTime, 0.f);
+	INC_DWORD_STAT_BY(STAT_WarriorArrowPhysicsSteps, NumSteps);
+
+	const float Alpha = Accumulator / StepTime;
+	for (FSimulatedArrow& Simulated : Arrows)
+	{
+		AArrow* Arrow = Simulated.Arrow.Get();
+		if (Arrow == nullptr || Arrow->IsPendingKill())
+		{
+			continue;
+		}
+		const USphereComponent* Collision = Arrow->GetCollisionComp();
+
+		if (NumSteps > 0)
+		{
+			FCollisionQueryParams QueryParams(SCENE_QUERY_STAT(WarriorArrowSweep), false, Arrow);
+			QueryParams.AddIgnoredActors(Collision->MoveIgnoreActors);
+			const FCollisionResponseParams ResponseParams(Collision->GetCollisionResponseToChannels());
+			const FCollisionShape Shape = FCollisionShape::MakeSphere(Simulated.Radius);
+
+			for (int32 StepIndex = 0; StepIndex < NumSteps; ++StepIndex)
+			{
+				Step(Simulated, StepTime);
+				Simulated.Sweeps.Add(GetWorld()->AsyncSweepByChannel(EAsyncTraceType::Single, Simulated.PreviousLocation, Simulated.Location, FQuat::Identity, Collision->GetCollisionObjectType(), Shape, QueryParams, ResponseParams));
+			}
+			INC_DWORD_STAT_BY(STAT_WarriorArrowPhysicsSweeps, NumSteps);
+		}
+
+		// Shown between the last two steps, the replicated movement picks the velocity up from the root
+		Arrow->SetActorLocationAndRotation(FMath::Lerp(Simulated.PreviousLocation, Simulated.Location, Alpha), Simulated.Velocity.Rotation(), false, nullptr, ETeleportType::TeleportPhysics);
+		Arrow->GetCollisionComp()->ComponentVelocity = Simulated.Velocity;
+		Arrow->GetProjectileMovement()->Velocity = Simulated.Velocity;
+	}
+	SET_DWORD_STAT(STAT_WarriorSimulatedArrows, Arrows.Num());
+}
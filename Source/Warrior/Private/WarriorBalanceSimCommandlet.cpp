@@ -0,0 +1,408 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorBalanceSimCommandlet.h"
+#include "Warrior.h"
+#include "Arrow.h"
+#include "WarriorCombatCharacter.h"
+#include "Async/ParallelFor.h"
+#include "Components/SphereComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/ProjectileMovementComponent.h"
+#include "HAL/PlatformTime.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+namespace WarriorBalanceSim
+{
+	/** One point of the tuning grid */
+	struct FTuning
+	{
+		float Damage;
+		float Health;
+		float ArrowSpeed;
+		float VolleyInterval;
+		float DetectionRadius;
+	};
+
+	/** Values that are not swept */
+	struct FSettings
+	{
+		float MoveSpeed;
+		float AttackInterval;
+		float ArrowLifeSpan;
+		float HitRadius;
+		float StartDistance;
+		float Spacing;
+		float MaxSeconds;
+		float TimeStep;
+		/** Scales how far a moving target drifts while an arrow flies, 0 for perfect aim */
+		float Evasion;
+		/** Extra arrows fired after the third attack of a combo */
+		int32 VolleyArrows;
+	};
+
+	struct FComposition
+	{
+		int32 NumWarriors[2];
+	};
+
+	struct FRunResult
+	{
+		/** Winning team, INDEX_NONE for a draw */
+		int32 Winner = INDEX_NONE;
+		float Duration = 0.f;
+		uint64 Cycles = 0;
+		/** From the first hit taken to death, per kill */
+		TArray<float, TInlineAllocator<16>> TimesToKill;
+	};
+
+	struct FWarrior
+	{
+		FVector2D Position;
+		float Health;
+		float Cooldown;
+		float VolleyTimer;
+		float FirstHitTime;
+		int32 Team;
+		int32 ComboStep;
+		int32 VolleyLeft;
+		bool bAttacking;
+	};
+
+	struct FArrow
+	{
+		int32 Target;
+		float HitTime;
+		bool bHits;
+	};
+
+	static void Run(const FTuning& Tuning, const FSettings& Settings, const FComposition& Composition, int32 Seed, FRunResult& Result)
+	{
+		const uint64 StartCycles = FPlatformTime::Cycles64();
+		FRandomStream Random(Seed);
+
+		TArray<FWarrior, TInlineAllocator<32>> Warriors;
+		for (int32 Team = 0; Team < 2; ++Team)
+		{
+			const int32 Count = Composition.NumWarriors[Team];
+			for (int32 Index = 0; Index < Count; ++Index)
+			{
+				FWarrior& Warrior = Warriors[Warriors.AddUninitialized()];
+				Warrior.Position = FVector2D(Team * Settings.StartDistance, (Index - (Count - 1) * 0.5f) * Settings.Spacing);
+				Warrior.Health = Tuning.Health;
+				// Warriors don't all swing in sync
+				Warrior.Cooldown = Random.FRand() * Settings.AttackInterval;
+				Warrior.VolleyTimer = 0.f;
+				Warrior.FirstHitTime = -1.f;
+				Warrior.Team = Team;
+				Warrior.ComboStep = 0;
+				Warrior.VolleyLeft = 0;
+				Warrior.bAttacking = false;
+			}
+		}
+
+		TArray<FArrow, TInlineAllocator<64>> Arrows;
+		int32 NumAlive[2] = { Composition.NumWarriors[0], Composition.NumWarriors[1] };
+
+		auto Fire = [&](const FWarrior& Shooter, int32 Target, float Now)
+		{
+			const FWarrior& Victim = Warriors[Target];
+			const float FlightTime = FVector2D::Distance(Shooter.Position, Victim.Position) / Tuning.ArrowSpeed;
+			if (FlightTime > Settings.ArrowLifeSpan)
+			{
+				return;
+			}
+
+			// Arrows are aimed where the target is, a moving target may have left by the time they land
+			const float Drift = Victim.bAttacking ? 0.f : Random.FRand() * Settings.MoveSpeed * FlightTime * Settings.Evasion;
+			FArrow& Arrow = Arrows[Arrows.AddUninitialized()];
+			Arrow.Target = Target;
+			Arrow.HitTime = Now + FlightTime;
+			Arrow.bHits = Drift <= Settings.HitRadius;
+		};
+
+		float Now = 0.f;
+		while (NumAlive[0] > 0 && NumAlive[1] > 0 && Now < Settings.MaxSeconds)
+		{
+			Now += Settings.TimeStep;
+
+			for (int32 ArrowIndex = Arrows.Num() - 1; ArrowIndex >= 0; --ArrowIndex)
+			{
+				const FArrow Arrow = Arrows[ArrowIndex];
+				if (Arrow.HitTime > Now)
+				{
+					continue;
+				}
+				Arrows.RemoveAtSwap(ArrowIndex, 1, false);
+
+				FWarrior& Victim = Warriors[Arrow.Target];
+				if (!Arrow.bHits || Victim.Health <= 0.f)
+				{
+					continue;
+				}
+				if (Victim.FirstHitTime < 0.f)
+				{
+					Victim.FirstHitTime = Now;
+				}
+				Victim.Health -= Tuning.Damage;
+				if (Victim.Health <= 0.f)
+				{
+					--NumAlive[Victim.Team];
+					Result.TimesToKill.Add(Now - Victim.FirstHitTime);
+				}
+			}
+
+			for (FWarrior& Warrior : Warriors)
+			{
+				if (Warrior.Health <= 0.f)
+				{
+					continue;
+				}
+
+				// Nearest enemy, like the targeting service's distance term
+				int32 Target = INDEX_NONE;
+				float TargetDistSq = MAX_flt;
+				for (int32 Other = 0; Other < Warriors.Num(); ++Other)
+				{
+					const FWarrior& Enemy = Warriors[Other];
+					if (Enemy.Team != Warrior.Team && Enemy.Health > 0.f)
+					{
+						const float DistSq = FVector2D::DistSquared(Warrior.Position, Enemy.Position);
+						if (DistSq < TargetDistSq)
+						{
+							TargetDistSq = DistSq;
+							Target = Other;
+						}
+					}
+				}
+				if (Target == INDEX_NONE)
+				{
+					break;
+				}
+
+				// The volley keeps going whatever the warrior does
+				if (Warrior.VolleyLeft > 0)
+				{
+					Warrior.VolleyTimer -= Settings.TimeStep;
+					if (Warrior.VolleyTimer <= 0.f)
+					{
+						Fire(Warrior, Target, Now);
+						--Warrior.VolleyLeft;
+						Warrior.VolleyTimer += Tuning.VolleyInterval;
+					}
+				}
+
+				if (TargetDistSq > FMath::Square(Tuning.DetectionRadius))
+				{
+					const FVector2D Direction = (Warriors[Target].Position - Warrior.Position).GetSafeNormal();
+					Warrior.Position += Direction * Settings.MoveSpeed * Settings.TimeStep;
+					Warrior.bAttacking = false;
+					continue;
+				}
+
+				Warrior.bAttacking = true;
+				Warrior.Cooldown -= Settings.TimeStep;
+				if (Warrior.Cooldown <= 0.f)
+				{
+					Fire(Warrior, Target, Now);
+					Warrior.Cooldown += Settings.AttackInterval;
+					if (++Warrior.ComboStep == 3)
+					{
+						Warrior.ComboStep = 0;
+						Warrior.VolleyLeft = Settings.VolleyArrows;
+						Warrior.VolleyTimer = Tuning.VolleyInterval;
+					}
+				}
+			}
+		}
+
+		Result.Winner = NumAlive[0] > 0 && NumAlive[1] == 0 ? 0 : (NumAlive[1] > 0 && NumAlive[0] == 0 ? 1 : INDEX_NONE);
+		Result.Duration = Now;
+		Result.Cycles = FPlatformTime::Cycles64() - StartCycles;
+	}
+
+	static TArray<float> ParseList(const FString& Params, const TCHAR* Name, float Default)
+	{
+		TArray<float> Values;
+		FString List;
+		if (FParse::Value(*Params, Name, List, false))
+		{
+			TArray<FString> Items;
+			List.ParseIntoArray(Items, TEXT(","));
+			for (const FString& Item : Items)
+			{
+				Values.Add(FCString::Atof(*Item));
+			}
+		}
+		if (Values.Num() == 0)
+		{
+			Values.Add(Default);
+		}
+		return Values;
+	}
+
+	static float Percentile(const TArray<float>& Sorted, float Fraction)
+	{
+		return Sorted.Num() > 0 ? Sorted[FMath::Clamp(FMath::FloorToInt(Fraction * Sorted.Num()), 0, Sorted.Num() - 1)] : 0.f;
+	}
+}
+
+UWarriorBalanceSimCommandlet::UWarriorBalanceSimCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UWarriorBalanceSimCommandlet::Main(const FString& Params)
+{
+	using namespace WarriorBalanceSim;
+
+	// Defaults come from the game classes so the sweep starts from what ships
+	UClass* WarriorClass = AWarriorCombatCharacter::StaticClass();
+	FString WarriorClassPath;
+	if (FParse::Value(*Params, TEXT("WarriorClass="), WarriorClassPath))
+	{
+		WarriorClass = LoadClass<AWarriorCombatCharacter>(nullptr, *WarriorClassPath);
+		if (WarriorClass == nullptr)
+		{
+			UE_LOG(LogWarrior, Error, TEXT("WarriorBalanceSim: could not load %s"), *WarriorClassPath);
+			return 1;
+		}
+	}
+	const AWarriorCombatCharacter* WarriorCDO = WarriorClass->GetDefaultObject<AWarriorCombatCharacter>();
+	const UClass* ArrowClass = WarriorCDO->ProjectileClass ? WarriorCDO->ProjectileClass.Get() : AArrow::StaticClass();
+	const AArrow* ArrowCDO = ArrowClass->GetDefaultObject<AArrow>();
+
+	const TArray<float> Damages = ParseList(Params, TEXT("Damage="), ArrowCDO->Damage);
+	const TArray<float> Healths = ParseList(Params, TEXT("Health="), WarriorCDO->DefaultHealth);
+	const TArray<float> ArrowSpeeds = ParseList(Params, TEXT("ArrowSpeed="), ArrowCDO->GetProjectileMovement()->InitialSpeed);
+	const TArray<float> VolleyIntervals = ParseList(Params, TEXT("VolleyInterval="), WarriorCDO->VolleyInterval);
+	const TArray<float> DetectionRadii = ParseList(Params, TEXT("DetectionRadius="), WarriorCDO->CollisionComp->GetUnscaledSphereRadius());
+
+	FSettings Settings;
+	Settings.MoveSpeed = WarriorCDO->GetCharacterMovement()->MaxWalkSpeed;
+	Settings.AttackInterval = 0.8f;
+	Settings.ArrowLifeSpan = ArrowCDO->InitialLifeSpan > 0.f ? ArrowCDO->InitialLifeSpan : MAX_flt;
+	Settings.HitRadius = 42.f + ArrowCDO->GetCollisionComp()->GetUnscaledSphereRadius();
+	Settings.StartDistance = 2000.f;
+	Settings.Spacing = 150.f;
+	Settings.MaxSeconds = 120.f;
+	Settings.TimeStep = 1.f / 30.f;
+	Settings.Evasion = 1.f;
+	Settings.VolleyArrows = 2;
+	FParse::Value(*Params, TEXT("AttackInterval="), Settings.AttackInterval);
+	FParse::Value(*Params, TEXT("StartDistance="), Settings.StartDistance);
+	FParse::Value(*Params, TEXT("MaxSeconds="), Settings.MaxSeconds);
+	FParse::Value(*Params, TEXT("Evasion="), Settings.Evasion);
+
+	TArray<FComposition> Compositions;
+	FString CompositionList = TEXT("4v4");
+	FParse::Value(*Params, TEXT("Compositions="), CompositionList, false);
+	{
+		TArray<FString> Items;
+		CompositionList.ParseIntoArray(Items, TEXT(","));
+		for (const FString& Item : Items)
+		{
+			FString Left, Right;
+			if (Item.Split(TEXT("v"), &Left, &Right))
+			{
+				FComposition& Composition = Compositions[Compositions.AddUninitialized()];
+				Composition.NumWarriors[0] = FMath::Max(FCString::Atoi(*Left), 1);
+				Composition.NumWarriors[1] = FMath::Max(FCString::Atoi(*Right), 1);
+			}
+		}
+	}
+
+	int32 Runs = 1000;
+	int32 Seed = 0;
+	FParse::Value(*Params, TEXT("Runs="), Runs);
+	FParse::Value(*Params, TEXT("Seed="), Seed);
+	Runs = FMath::Max(Runs, 1);
+
+	TArray<FTuning> Grid;
+	for (float Damage : Damages)
+	for (float Health : Healths)
+	for (float ArrowSpeed : ArrowSpeeds)
+	for (float VolleyInterval : VolleyIntervals)
+	for (float DetectionRadius : DetectionRadii)
+	{
+		Grid.Add({ Damage, Health, FMath::Max(ArrowSpeed, 1.f), VolleyInterval, DetectionRadius });
+	}
+
+	UE_LOG(LogWarrior, Display, TEXT("WarriorBalanceSim: %d tunings x %d compositions x %d runs"), Grid.Num(), Compositions.Num(), Runs);
+
+	FString Csv = TEXT("Composition,Damage,Health,ArrowSpeed,VolleyInterval,DetectionRadius,Runs,WinRateA,WinRateB,DrawRate,DurationP50,TimeToKillP10,TimeToKillP50,TimeToKillP90,UsPerSim") LINE_TERMINATOR;
+	UE_LOG(LogWarrior, Display, TEXT("Comp   Damage  Health  Speed  Volley  Detect   WinA   WinB   Draw  BattleS  TTK p10/p50/p90    us/sim"));
+
+	const double SweepStart = FPlatformTime::Seconds();
+	TArray<FRunResult> Results;
+	int64 TotalSims = 0;
+	for (const FComposition& Composition : Compositions)
+	{
+		for (int32 TuningIndex = 0; TuningIndex < Grid.Num(); ++TuningIndex)
+		{
+			const FTuning& Tuning = Grid[TuningIndex];
+
+			// Each run only writes its own result, no locking
+			Results.Reset();
+			Results.SetNum(Runs);
+			ParallelFor(Runs, [&](int32 RunIndex)
+			{
+				Run(Tuning, Settings, Composition, HashCombine(GetTypeHash(Seed + TuningIndex), GetTypeHash(RunIndex)), Results[RunIndex]);
+			});
+			TotalSims += Runs;
+
+			int32 Wins[2] = { 0, 0 };
+			uint64 Cycles = 0;
+			TArray<float> Durations;
+			TArray<float> TimesToKill;
+			Durations.Reserve(Runs);
+			for (const FRunResult& Result : Results)
+			{
+				if (Result.Winner != INDEX_NONE)
+				{
+					++Wins[Result.Winner];
+				}
+				Cycles += Result.Cycles;
+				Durations.Add(Result.Duration);
+				TimesToKill.Append(Result.TimesToKill.GetData(), Result.TimesToKill.Num());
+			}
+			Durations.Sort();
+			TimesToKill.Sort();
+
+			const FString CompositionName = FString::Printf(TEXT("%dv%d"), Composition.NumWarriors[0], Composition.NumWarriors[1]);
+			const float WinRateA = float(Wins[0]) / Runs;
+			const float WinRateB = float(Wins[1]) / Runs;
+			const float DrawRate = 1.f - WinRateA - WinRateB;
+			const double UsPerSim = FPlatformTime::ToMilliseconds64(Cycles) * 1000.0 / Runs;
+
+			UE_LOG(LogWarrior, Display, TEXT("%-5s  %6.1f  %6.0f  %5.0f  %6.2f  %6.0f  %4.0f%%  %4.0f%%  %4.0f%%  %7.1f  %4.1f / %4.1f / %4.1f  %8.1f"),
+				*CompositionName, Tuning.Damage, Tuning.Health, Tuning.ArrowSpeed, Tuning.VolleyInterval, Tuning.DetectionRadius,
+				WinRateA * 100.f, WinRateB * 100.f, DrawRate * 100.f, Percentile(Durations, 0.5f),
+				Percentile(TimesToKill, 0.1f), Percentile(TimesToKill, 0.5f), Percentile(TimesToKill, 0.9f), UsPerSim);
+
+			Csv += FString::Printf(TEXT("%s,%.2f,%.2f,%.1f,%.3f,%.1f,%d,%.4f,%.4f,%.4f,%.3f,%.3f,%.3f,%.3f,%.2f") LINE_TERMINATOR,
+				*CompositionName, Tuning.Damage, Tuning.Health, Tuning.ArrowSpeed, Tuning.VolleyInterval, Tuning.DetectionRadius, Runs,
+				WinRateA, WinRateB, DrawRate, Percentile(Durations, 0.5f),
+				Percentile(TimesToKill, 0.1f), Percentile(TimesToKill, 0.5f), Percentile(TimesToKill, 0.9f), UsPerSim);
+		}
+	}
+	const double SweepSeconds = FPlatformTime::Seconds() - SweepStart;
+
+	UE_LOG(LogWarrior, Display, TEXT("WarriorBalanceSim: %lld simulations in %.1fs on %d workers (%.1f us wall per simulation)"),
+		TotalSims, SweepSeconds, FTaskGraphInterface::Get().GetNumWorkerThreads() + 1, TotalSims > 0 ? SweepSeconds * 1000000.0 / TotalSims : 0.0);
+
+	FString CsvPath;
+	if (!FParse::Value(*Params, TEXT("Csv="), CsvPath))
+	{
+		CsvPath = FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorBalanceSim-%s.csv"), *FDateTime::Now().ToString());
+	}
+	if (FFileHelper::SaveStringToFile(Csv, *CsvPath))
+	{
+		UE_LOG(LogWarrior, Display, TEXT("WarriorBalanceSim: results in %s"), *FPaths::ConvertRelativePathToFull(CsvPath));
+	}
+	return 0;
+}
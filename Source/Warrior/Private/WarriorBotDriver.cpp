@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorBotDriver.h"
+#include "Warrior.h"
+#include "WarriorCharacter.h"
+#include "Engine/Engine.h"
+#include "Engine/GameInstance.h"
+#include "Engine/GameViewportClient.h"
+#include "Engine/LocalPlayer.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "Misc/CommandLine.h"
+
+DECLARE_CYCLE_STAT(TEXT("Bot Driver Tick"), STAT_WarriorBotDriverTick, STATGROUP_Warrior);
+
+namespace WarriorBot
+{
+	struct FScriptStep
+	{
+		float Forward;
+		float Right;
+		float YawDelta;
+		float Duration;
+		bool bAttack;
+	};
+
+	/** Sequence played by scripted bots, a loop around a square with a combo at every corner */
+	static const FScriptStep Script[] =
+	{
+		{ 1.f,  0.f,  0.f, 2.0f, false },
+		{ 0.f,  0.f,  0.f, 0.6f, true  },
+		{ 0.f,  0.f,  0.f, 0.6f, true  },
+		{ 0.f,  0.f,  0.f, 0.6f, true  },
+		{ 0.f,  1.f, 90.f, 2.0f, false },
+		{ 0.f,  0.f,  0.f, 0.6f, true  },
+		{-1.f,  0.f,  0.f, 2.0f, false },
+		{ 0.f, -1.f,  0.f, 2.0f, false },
+	};
+
+	/** Time between the attack press and the arrow release, stands in for the anim notify */
+	static const float ReleaseDelay = 0.3f;
+}
+
+FWarriorBotDriver::FWarriorBotDriver(int32 InNumBots, EWarriorBotBehavior InBehavior, int32 InSeed)
+	: NumBots(InNumBots)
+	, Behavior(InBehavior)
+	, Random(InSeed)
+	, bSpawnedLocalBots(false)
+{
+}
+
+TUniquePtr<FWarriorBotDriver> FWarriorBotDriver::CreateFromCommandLine()
+{
+	int32 NumBots = 0;
+	if (!FParse::Value(FCommandLine::Get(), TEXT("WarriorBots="), NumBots) || NumBots <= 0)
+	{
+		return nullptr;
+	}
+
+	FString BehaviorName;
+	FParse::Value(FCommandLine::Get(), TEXT("WarriorBotBehavior="), BehaviorName);
+	const EWarriorBotBehavior Behavior = BehaviorName == TEXT("Scripted") ? EWarriorBotBehavior::Scripted : EWarriorBotBehavior::Random;
+
+	int32 Seed = FPlatformProcess::GetCurrentProcessId();
+	FParse::Value(FCommandLine::Get(), TEXT("WarriorBotSeed="), Seed);
+
+	UE_LOG(LogWarrior, Log, TEXT("Bot driver: %d bots, %s behavior, seed %d"), NumBots, *BehaviorName, Seed);
+	return MakeUnique<FWarriorBotDriver>(NumBots, Behavior, Seed);
+}
+
+TStatId FWarriorBotDriver::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(FWarriorBotDriver, STATGROUP_Tickables);
+}
+
+void FWarriorBotDriver::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorBotDriverTick);
+
+	if (GEngine == nullptr)
+	{
+		return;
+	}
+
+	for (const FWorldContext& Context : GEngine->GetWorldContexts())
+	{
+		UWorld* World = Context.World();
+		if (World == nullptr || Context.WorldType != EWorldType::Game || World->GetGameInstance() == nullptr)
+		{
+			continue;
+		}
+
+		SpawnLocalBots(World);
+
+		const TArray<ULocalPlayer*>& LocalPlayers = World->GetGameInstance()->GetLocalPlayers();
+		if (Bots.Num() < LocalPlayers.Num())
+		{
+			const int32 FirstNew = Bots.AddZeroed(LocalPlayers.Num() - Bots.Num());
+			for (int32 Index = FirstNew; Index < Bots.Num(); ++Index)
+			{
+				// Spread the first decisions so the bots don't act in lock step
+				Bots[Index].TimeToNextAttack = Random.FRandRange(0.5f, 2.f);
+				Bots[Index].TimeToRelease = -1.f;
+			}
+		}
+
+		for (int32 Index = 0; Index < LocalPlayers.Num(); ++Index)
+		{
+			APlayerController* Controller = LocalPlayers[Index] ? LocalPlayers[Index]->PlayerController : nullptr;
+			AWarriorCharacter* Warrior = Controller ? Cast<AWarriorCharacter>(Controller->GetPawn()) : nullptr;
+			if (Warrior)
+			{
+				DriveBot(Controller, Warrior, Bots[Index], DeltaTime);
+			}
+		}
+	}
+}
+
+void FWarriorBotDriver::SpawnLocalBots(UWorld* World)
+{
+	// Wait for the primary player to be in the match before asking for more seats
+	if (bSpawnedLocalBots || World->GetFirstPlayerController() == nullptr || World->GetFirstPlayerController()->GetPawn() == nullptr)
+	{
+		return;
+	}
+	bSpawnedLocalBots = true;
+
+	UGameInstance* GameInstance = World->GetGameInstance();
+	if (UGameViewportClient* Viewport = GameInstance->GetGameViewportClient())
+	{
+		Viewport->MaxSplitscreenPlayers = FMath::Max(Viewport->MaxSplitscreenPlayers, NumBots);
+	}
+
+	for (int32 Index = GameInstance->GetNumLocalPlayers(); Index < NumBots; ++Index)
+	{
+		// On a client this sends a split join request, the server spawns the extra pawns
+		FString Error;
+		if (GameInstance->CreateLocalPlayer(-1, Error, true) == nullptr)
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("Bot driver: could not add local player %d: %s"), Index, *Error);
+			break;
+		}
+	}
+}
+
+void FWarriorBotDriver::DriveBot(APlayerController* Controller, AWarriorCharacter* Warrior, FBotState& State, float DeltaTime)
+{
+	State.TimeToNextDecision -= DeltaTime;
+	if (State.TimeToNextDecision <= 0.f)
+	{
+		if (Behavior == EWarriorBotBehavior::Scripted)
+		{
+			DecideScripted(Controller, State);
+		}
+		else
+		{
+			DecideRandom(Controller, State);
+		}
+	}
+
+	Warrior->MoveForward(State.Forward);
+	Warrior->MoveRight(State.Right);
+
+	State.TimeToNextAttack -= DeltaTime;
+	if (State.TimeToNextAttack <= 0.f && State.TimeToRelease < 0.f)
+	{
+		Warrior->Attack();
+		State.TimeToRelease = WarriorBot::ReleaseDelay;
+		State.TimeToNextAttack = Behavior == EWarriorBotBehavior::Scripted ? TNumericLimits<float>::Max() : Random.FRandRange(0.5f, 3.f);
+	}
+
+	if (State.TimeToRelease >= 0.f)
+	{
+		State.TimeToRelease -= DeltaTime;
+		if (State.TimeToRelease < 0.f)
+		{
+			// No animation runs on a headless client, fire the notifies ourselves
+			Warrior->SpawnProjectileArrow();
+			Warrior->ResetCombo();
+			if (Warrior->AttackCount >= 3)
+			{
+				Warrior->AttackCount = 0;
+			}
+		}
+	}
+}
+
+void FWarriorBotDriver::DecideRandom(APlayerController* Controller, FBotState& State)
+{
+	State.Forward = Random.FRandRange(0.3f, 1.f);
+	State.Right = Random.FRandRange(-0.5f, 0.5f);
+	State.TimeToNextDecision = Random.FRandRange(1.f, 3.f);
+
+	FRotator ControlRotation = Controller->GetControlRotation();
+	ControlRotation.Yaw += Random.FRandRange(-90.f, 90.f);
+	Controller->SetControlRotation(ControlRotation);
+}
+
+void FWarriorBotDriver::DecideScripted(APlayerController* Controller, FBotState& State)
+{
+	const WarriorBot::FScriptStep& Step = WarriorBot::Script[State.ScriptStep];
+	State.ScriptStep = (State.ScriptStep + 1) % ARRAY_COUNT(WarriorBot::Script);
+
+	State.Forward = Step.Forward;
+	State.Right = Step.Right;
+	State.TimeToNextDecision = Step.Duration;
+	State.TimeToNextAttack = Step.bAttack ? 0.f : TNumericLimits<float>::Max();
+
+	FRotator ControlRotation = Controller->GetControlRotation();
+	ControlRotation.Yaw += Step.YawDelta;
+	Controller->SetControlRotation(ControlRotation);
+}
@@ -0,0 +1,723 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorCombatCharacter.h"
+#include "Components/CapsuleComponent.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "GameFramework/Controller.h"
+#include "DrawDebugHelpers.h"
+#include "Arrow.h"
+#include "BoxActor.h"
+#include "Components/SphereComponent.h"
+#include "Components/SkeletalMeshComponent.h"
+#include "WarriorTargetingService.h"
+#include "WarriorTelemetry.h"
+#include "WarriorStreamingGrid.h"
+#include "WarriorSquadService.h"
+#include "WarriorNavigationService.h"
+#include "WarriorArenaManager.h"
+#include "WarriorComboState.h"
+#include "WarriorAimService.h"
+#include "WarriorMemoryTracker.h"
+#include "WarriorPawnPool.h"
+#include "WarriorLatencyTrace.h"
+#include "WarriorMovementComponent.h"
+#include "Animation/AnimInstance.h"
+#include "Net/UnrealNetwork.h"
+
+AWarriorCombatCharacter::AWarriorCombatCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer.SetDefaultSubobjectClass<UWarriorMovementComponent>(ACharacter::CharacterMovementComponentName))
+{
+	WARRIOR_LLM_SCOPE(Warriors);
+
+	// Set size for collision capsule
+	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
+	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
+	CollisionComp->SetupAttachment(RootComponent);
+
+
+
+	// Don't rotate when the controller rotates. Let that just affect the camera.
+	bUseControllerRotationPitch = false;
+	bUseControllerRotationYaw = false;
+	bUseControllerRotationRoll = false;
+
+	// Configure character movement
+	GetCharacterMovement()->bOrientRotationToMovement = true; // Character moves in the direction of input...	
+	GetCharacterMovement()->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
+	GetCharacterMovement()->JumpZVelocity = 600.f;
+	GetCharacterMovement()->AirControl = 0.2f;
+
+	
+	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
+	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
+	
+	AttackCount = 0;
+
+	//Init health
+
+	DefaultHealth = 100;
+	Health = DefaultHealth;
+	HealthPercentage = 1.0;
+
+
+	//Detection Component
+	
+	// Use a sphere as a simple collision representation
+	//RootComponent = GetCapsuleComponent();
+	
+	CollisionComp->InitSphereRadius(300.0f);
+	//CollisionComp->BodyInstance.SetCollisionProfileName("Detection");
+	CollisionComp->OnComponentBeginOverlap.AddDynamic(this, &AWarriorCombatCharacter::OnHit);		// set up a notification for when this component hits something blocking
+
+	// Players can't walk on it
+	//CollisionComp->SetWalkableSlopeOverride(FWalkableSlopeOverride(WalkableSlope_Unwalkable, 0.f));
+	//CollisionComp->CanCharacterStepUpOn = ECB_No;
+
+	AttackOnOff = false;
+	VolleyInterval = 0.2f;
+	MinArrowInterval = 0.25f;
+
+	TargetMaxStaleness = 0.5f;
+
+	BoxSpawnLocation = FVector(-1000, 1000, 200);
+	bStreamingSuspended = false;
+	bPooled = false;
+	bSwingArrowReady = false;
+	LastSwingArrowTime = -1.e6f;
+	LatencyTraceId = 0;
+	ComboState = nullptr;
+	SlowFactor = 0.f;
+
+	// AI warriors need a controller for their movement input to be consumed, see PostInitializeComponents
+	AutoPossessAI = EAutoPossessAI::PlacedInWorldOrSpawned;
+	
+}
+
+
+int i;
+void AWarriorCombatCharacter::PostInitializeComponents()
+{
+	// Spawned player side pawns are for PlayerControllers, an AI controller spawned for them would be orphaned
+	if (Team == false)
+	{
+		AutoPossessAI = EAutoPossessAI::PlacedInWorld;
+	}
+
+	Super::PostInitializeComponents();
+}
+
+// Called when the game starts or when spawned
+void AWarriorCombatCharacter::BeginPlay()
+{
+	WARRIOR_LLM_SCOPE(Warriors);
+
+	Super::BeginPlay();
+
+	FWarriorMemoryTracker::OnSpawned(EWarriorMemoryClass::Warrior, this);
+
+	i = 0;
+	AWarriorStreamingGrid* Grid = Role == ROLE_Authority ? AWarriorWorldService::Get<AWarriorStreamingGrid>(this, false) : nullptr;
+	if (Team == true && Role == ROLE_Authority && !bPooled)
+	{
+		FVector BoxPos = BoxSpawnLocation;
+		UWorld* const World = GetWorld();
+		const FRotator SpawnRotation = GetActorRotation();
+		WARRIOR_LLM_SCOPE(Boxes);
+		AWarriorArenaManager* Arenas = Grid ? nullptr : AWarriorWorldService::Get<AWarriorArenaManager>(this, false);
+		FVector ArenaOrigin;
+		ULevel* ArenaLevel = nullptr;
+		if (Grid)
+		{
+			// The box lives and dies with the cell the warrior starts in
+			Grid->SpawnInCell(Box, Grid->GetCellAt(GetActorLocation()), FTransform(SpawnRotation, BoxPos));
+		}
+		else if (Arenas && Arenas->GetArenaFrame(GetActorLocation(), ArenaOrigin, ArenaLevel))
+		{
+			// In the warrior's own arena, and part of its level instance so the next reload clears it
+			FActorSpawnParameters ActorSpawnParams;
+			ActorSpawnParams.OverrideLevel = ArenaLevel;
+			GetWorld()->SpawnActor<ABoxActor>(Box, ArenaOrigin + BoxPos, SpawnRotation, ActorSpawnParams);
+		}
+		else
+		{
+			FActorSpawnParameters ActorSpawnParams;
+			GetWorld()->SpawnActor<ABoxActor>(Box, BoxPos, SpawnRotation, ActorSpawnParams);
+		}
+	}
+
+	if (Role == ROLE_Authority)
+	{
+		FActorSpawnParameters ComboSpawnParams;
+		ComboSpawnParams.Owner = this;
+		ComboState = GetWorld()->SpawnActor<AWarriorComboState>(ComboSpawnParams);
+		if (ComboState)
+		{
+			ComboState->Warrior = this;
+			ComboState->Team = Team;
+		}
+	}
+
+	// Warriors prewarmed by the pool stay frozen and join the services when they are handed out
+	if (bPooled)
+	{
+		SetFrozen(true);
+	}
+	else
+	{
+		RegisterWithServices();
+	}
+}
+
+void AWarriorCombatCharacter::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	UnregisterFromServices();
+	if (ComboState)
+	{
+		ComboState->Destroy();
+		ComboState = nullptr;
+	}
+	FWarriorMemoryTracker::OnDestroyed(EWarriorMemoryClass::Warrior, this);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+
+
+void AWarriorCombatCharacter::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	// get first player pawn location
+	//FVector MyCharacter = GetWorld()->GetFirstPlayerController()->GetPawn()->GetActorLocation();
+	PlayerPosition = this->GetActorLocation();
+	// screen log player location
+	//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Blue, FString::Printf(TEXT("Player Location: %s"), *NewChar.ToString()));	
+	//bool check = IsMoving();
+
+	
+	
+	if (i == 5)
+	{
+		if (IsMoving() == true)
+		{
+			AttackCount = 0;
+			PublishComboState();
+
+			GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::White, TEXT("Reset the attack count"));
+		}
+	}
+
+	i += 1;
+
+	if (i > 11)
+	{
+		i = 1;
+	}
+	
+	/*
+	if (IsMoving() == true )
+	{
+		AttackCount = 0;
+	}
+	*/
+}
+
+void AWarriorCombatCharacter::Attack()
+{
+	if (Role < ROLE_Authority)
+	{
+		ServerAttack();
+	}
+
+	OnAttackStarted();
+
+	if (GEngine)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("Attack Pressed"));
+		//IsAttacking = true;
+	}
+
+	IsAttacking = true;
+	AttackCount += 1;
+	if (Role == ROLE_Authority)
+	{
+		bSwingArrowReady = true;
+	}
+	FWarriorTelemetry::Record(EWarriorTelemetryEvent::AttackPressed, this, nullptr, AttackCount, GetActorLocation());
+	GoToSwitch();
+	PublishComboState();
+
+	/*
+	if (IsAttacking == true)
+	{
+		SaveAttack = true;
+	}
+	else
+	{
+		IsAttacking = true;
+		GoToSwitch();
+	}
+	*/
+	/*Line Trace*/
+
+	FHitResult OutHit;
+
+
+	FVector Initpos = this->GetActorLocation();
+	FVector TempVector = this->GetActorForwardVector();
+	FVector Finalpos = ((TempVector *100.f + Initpos));
+	Finalpos = Finalpos + FVector(0, 0, 50);
+
+
+	//FVector Start = this->GetActorLocation();
+	
+
+	// alternatively you can get the camera location
+	// FVector Start = FirstPersonCameraComponent->GetComponentLocation();
+
+	FVector Start = Finalpos;
+	FVector ForwardVector = GetAimRotation(Start).Vector();
+	FVector End = ((ForwardVector * 2000.f) + Start);
+	FCollisionQueryParams CollisionParams;
+
+	//DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 5, 0, 1);
+
+	if(GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_PhysicsBody, CollisionParams))
+	{
+		if(OutHit.bBlockingHit)
+		{
+			if (Role == ROLE_Authority && MeleeStatusEffects.Num() > 0)
+			{
+				if (AWarriorStatusEffectService* StatusEffectService = AWarriorWorldService::Get<AWarriorStatusEffectService>(this))
+				{
+					StatusEffectService->ApplyEffects(OutHit.GetActor(), MeleeStatusEffects, GetController());
+				}
+			}
+            if (GEngine) {
+				/*
+			    GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Red, FString::Printf(TEXT("You are hitting: %s"), *OutHit.GetActor()->GetName()));
+			    GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Red, FString::Printf(TEXT("Impact Point: %s"), *OutHit.ImpactPoint.ToString()));
+                GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Red, FString::Printf(TEXT("Normal Point: %s"), *OutHit.ImpactNormal.ToString()));
+				*/
+            }
+		}
+	}
+
+	//projectile
+	//UWorld* const World = GetWorld();
+
+	//const FRotator SpawnRotation = GetActorRotation();
+	//Set Spawn Collision Handling Override
+	//FActorSpawnParameters ActorSpawnParams;
+	//ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	//FVector SpawnLocation = Start;
+
+	//World->SpawnActor<AArrow>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+
+	//SpawnProjectileArrow(Start);
+}
+
+void AWarriorCombatCharacter::SpawnProjectileArrow()
+{
+	if (Role < ROLE_Authority)
+	{
+		ServerSpawnProjectileArrow();
+		return;
+	}
+
+	// One arrow per swing, whichever of the server's and the owning client's notifies comes first
+	const float Now = GetWorld()->GetTimeSeconds();
+	if (!bSwingArrowReady || Now - LastSwingArrowTime < MinArrowInterval)
+	{
+		return;
+	}
+	bSwingArrowReady = false;
+	LastSwingArrowTime = Now;
+
+	ShootArrow(GetArrowSpawnLocation());
+
+	if (AttackCount == 3  && AttackOnOff == true)
+	{
+		count=2;
+		GetWorld()->GetTimerManager().SetTimer(Delay, this, &AWarriorCombatCharacter::TimerEnd, VolleyInterval, false);
+	}
+
+}
+
+void AWarriorCombatCharacter::ServerAttack_Implementation()
+{
+	// The client's trace stays on the client, the server traces from here
+	LatencyTraceId = FWarriorLatencyTrace::BeginTrace();
+	Attack();
+}
+
+bool AWarriorCombatCharacter::ServerAttack_Validate()
+{
+	return true;
+}
+
+void AWarriorCombatCharacter::ServerSpawnProjectileArrow_Implementation()
+{
+	SpawnProjectileArrow();
+}
+
+bool AWarriorCombatCharacter::ServerSpawnProjectileArrow_Validate()
+{
+	return true;
+}
+
+void AWarriorCombatCharacter::TimerEnd()
+{
+	if (count != 0)
+	{
+		ShootArrow(GetArrowSpawnLocation());
+		count -= 1;
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Magenta, FString::Printf(TEXT("Delay Test")));
+		GetWorld()->GetTimerManager().SetTimer(Delay, this, &AWarriorCombatCharacter::TimerEnd, VolleyInterval, false);
+		AttackOnOff = false;
+		PublishComboState();
+	}
+	
+}
+
+FVector AWarriorCombatCharacter::GetArrowSpawnLocation() const
+{
+	return GetActorLocation() + GetActorForwardVector() * 100.f + FVector(0, 0, 50);
+}
+
+FRotator AWarriorCombatCharacter::GetAimRotation(const FVector& SpawnLocation) const
+{
+	if (AActor* Target = GetCurrentTarget())
+	{
+		return (Target->GetActorLocation() - SpawnLocation).Rotation();
+	}
+	return GetActorRotation();
+}
+
+void AWarriorCombatCharacter::ShootArrow(const FVector& SpawnLocation)
+{
+	AActor* Target = IsPlayerControlled() ? nullptr : GetCurrentTarget();
+	if (Target)
+	{
+		if (AWarriorAimService* Aim = AWarriorWorldService::Get<AWarriorAimService>(this))
+		{
+			Aim->QueueShot(this, Target, SpawnLocation);
+			return;
+		}
+	}
+	SpawnArrow(SpawnLocation, GetAimRotation(SpawnLocation));
+}
+
+AArrow* AWarriorCombatCharacter::SpawnArrow(const FVector& SpawnLocation, const FRotator& SpawnRotation)
+{
+	// The arrow object itself is allocated before its constructor runs, so the scope goes around the spawn
+	WARRIOR_LLM_SCOPE(Arrows);
+
+	//Set Spawn Collision Handling Override
+	FActorSpawnParameters ActorSpawnParams;
+	//ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
+
+	ActorSpawnParams.Owner = this;
+	ActorSpawnParams.Instigator = this;
+
+	AArrow* Arrow = GetWorld()->SpawnActor<AArrow>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
+	FWarriorTelemetry::Record(EWarriorTelemetryEvent::ArrowSpawned, this, Arrow, 0.f, SpawnLocation);
+	if (Arrow)
+	{
+		Arrow->LatencyTraceId = LatencyTraceId;
+		FWarriorLatencyTrace::Mark(LatencyTraceId, EWarriorLatencyStage::ArrowSpawned);
+	}
+	return Arrow;
+}
+
+AActor* AWarriorCombatCharacter::GetCurrentTarget() const
+{
+	AWarriorTargetingService* Targeting = AWarriorWorldService::Get<AWarriorTargetingService>(this, false);
+	return Targeting ? Targeting->GetTarget(this, TargetMaxStaleness) : nullptr;
+}
+
+void AWarriorCombatCharacter::ComboAttackSave()
+{
+	if (SaveAttack == true)
+	{
+		SaveAttack = false;
+		GoToSwitch();
+	}
+}
+
+void AWarriorCombatCharacter::GoToSwitch()
+{
+	FWarriorLatencyTrace::Mark(LatencyTraceId, EWarriorLatencyStage::AttackStarted);
+
+	//UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
+	
+	switch (AttackCount)
+	{
+	case 1:
+		//AttackCount = 1;
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Attack 1")));
+		//Animation 1
+		
+		break;
+	case 2:
+		//AttackCount = 2;
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Attack 2")));
+		//Animation 1
+		
+		break;
+	case 3:
+		
+		//AttackCount = 0;
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Attack 3")));
+		AttackOnOff = true;
+
+		//ComboAnim
+		
+		
+		break;
+	default:
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Error")));
+
+	}
+}
+
+void AWarriorCombatCharacter::ResetCombo()
+{
+	IsAttacking = false;
+	//AttackCount = 0;
+	SaveAttack = false;
+	PublishComboState();
+}
+
+bool AWarriorCombatCharacter::IsMoving()
+{
+	//if (this->GetVelocity.SizeSquared() < 5)
+	if(GetCharacterMovement()->Velocity.Size() == 0)
+	{
+		//character is not moving
+		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, FString::Printf(TEXT("Player not moving")));
+		return false;
+	}
+	else
+	{
+		//Character is moving
+		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Player Moving")));
+		return true;
+
+	}
+}
+
+
+float AWarriorCombatCharacter::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, class AActor* DamageCauser)
+{
+	// Dead and waiting in the pool
+	if (bPooled)
+	{
+		return 0.f;
+	}
+
+	Health -= DamageAmount;
+	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("TakeDamage Function Called in WarriorCharacter, Damage recieved"));
+	FWarriorTelemetry::Record(EWarriorTelemetryEvent::DamageApplied, DamageCauser, this, DamageAmount, GetActorLocation());
+	if (const AArrow* Arrow = Cast<AArrow>(DamageCauser))
+	{
+		FWarriorLatencyTrace::Mark(Arrow->LatencyTraceId, EWarriorLatencyStage::DamageApplied);
+	}
+
+	if (Health <= 0)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::White, TEXT("Character Destroyed"));
+		FWarriorTelemetry::Record(EWarriorTelemetryEvent::Death, DamageCauser, this, Health, GetActorLocation());
+		if (AWarriorArenaManager* Arenas = AWarriorWorldService::Get<AWarriorArenaManager>(this, false))
+		{
+			Arenas->OnWarriorKilled(this, DamageCauser);
+		}
+
+		// Pooled warriors are kept for the next respawn instead of being rebuilt
+		AWarriorPawnPool* Pool = AWarriorWorldService::Get<AWarriorPawnPool>(this);
+		if (Pool == nullptr || !Pool->Release(this))
+		{
+			Destroy(this);
+		}
+	}
+	return Health;
+}
+
+void AWarriorCombatCharacter::OnHit(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
+{
+	//GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Yellow, FString::Printf(TEXT("Object detected : %s"), *OtherComp->GetName()));
+	AWarriorCombatCharacter* WarriorChar = Cast<AWarriorCombatCharacter>(OtherActor);
+	if (!WarriorChar) return;
+	if ((OtherActor!=this) && OtherActor == WarriorChar && OtherComp != WarriorChar->CollisionComp && !Team)
+	{
+		GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Yellow, FString::Printf(TEXT("Object detected is a WarriorCharacter: %s"), *OtherActor->GetName()));
+
+		// Item is a weapon
+		//GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Yellow, FString::Printf(TEXT("Object detected is a WarriorCharacter: %s"), *OtherActor->GetName()));
+
+	}
+
+	// AI warriors outside a squad run after the enemies they detect, squads follow their leader's target
+	if (Role == ROLE_Authority && OtherActor != this && OtherComp != WarriorChar->CollisionComp && WarriorChar->Team != Team
+		&& !IsPlayerControlled() && WarriorChar->Health > 0.f)
+	{
+		AWarriorSquadService* Squads = AWarriorWorldService::Get<AWarriorSquadService>(this, false);
+		if (Squads == nullptr || Squads->GetSquadId(this) == INDEX_NONE)
+		{
+			AWarriorNavigationService* Navigation = AWarriorWorldService::Get<AWarriorNavigationService>(this);
+			if (!Navigation->IsChasing(this))
+			{
+				Navigation->ChaseTarget(this, WarriorChar);
+			}
+		}
+	}
+}
+
+void AWarriorCombatCharacter::SetStreamingSuspended(bool bSuspend)
+{
+	bStreamingSuspended = bSuspend;
+
+	SetFrozen(bSuspend || bPooled);
+}
+
+void AWarriorCombatCharacter::SetPooled(bool bInPool)
+{
+	if (bPooled == bInPool)
+	{
+		return;
+	}
+	bPooled = bInPool;
+
+	// Flagged before BeginPlay by the pool prewarm, BeginPlay does the rest
+	if (!HasActorBegunPlay())
+	{
+		return;
+	}
+
+	if (bInPool)
+	{
+		UnregisterFromServices();
+		GetWorldTimerManager().ClearTimer(Delay);
+		if (UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance())
+		{
+			AnimInstance->StopAllMontages(0.f);
+		}
+	}
+	SetFrozen(bInPool || bStreamingSuspended);
+	if (!bInPool)
+	{
+		RegisterWithServices();
+	}
+}
+
+void AWarriorCombatCharacter::ResetForRespawn()
+{
+	Health = DefaultHealth;
+	HealthPercentage = 1.0;
+	AttackCount = 0;
+	IsAttacking = false;
+	SaveAttack = false;
+	AttackOnOff = false;
+	count = 0;
+	bSwingArrowReady = false;
+	PublishComboState();
+}
+
+void AWarriorCombatCharacter::SetSlowFactor(float Slow)
+{
+	SlowFactor = FMath::Clamp(Slow, 0.f, 1.f);
+}
+
+void AWarriorCombatCharacter::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	// Simulated proxies follow the replicated movement, only the owner predicts with the slow
+	DOREPLIFETIME_CONDITION(AWarriorCombatCharacter, SlowFactor, COND_OwnerOnly);
+}
+
+void AWarriorCombatCharacter::SetFrozen(bool bFrozen)
+{
+	SetActorHiddenInGame(bFrozen);
+	SetActorEnableCollision(!bFrozen);
+	SetActorTickEnabled(!bFrozen);
+	if (bFrozen)
+	{
+		GetCharacterMovement()->StopMovementImmediately();
+	}
+	GetCharacterMovement()->SetComponentTickEnabled(!bFrozen);
+	GetMesh()->SetComponentTickEnabled(!bFrozen);
+
+	// Nothing changes while frozen, stop replicating until it wakes up
+	if (Role == ROLE_Authority)
+	{
+		SetNetDormancy(bFrozen ? DORM_DormantAll : DORM_Awake);
+	}
+}
+
+void AWarriorCombatCharacter::RegisterWithServices()
+{
+	if (Role < ROLE_Authority)
+	{
+		return;
+	}
+
+	if (AWarriorStreamingGrid* Grid = AWarriorWorldService::Get<AWarriorStreamingGrid>(this, false))
+	{
+		Grid->RegisterWarrior(this);
+	}
+
+	// AI side moves in squads
+	if (Team == true)
+	{
+		if (AWarriorSquadService* Squads = AWarriorWorldService::Get<AWarriorSquadService>(this))
+		{
+			Squads->AssignToSquad(this);
+		}
+	}
+
+	// Targets are only needed where arrows are spawned
+	if (AWarriorTargetingService* Targeting = AWarriorWorldService::Get<AWarriorTargetingService>(this))
+	{
+		Targeting->RegisterWarrior(this);
+	}
+}
+
+void AWarriorCombatCharacter::UnregisterFromServices()
+{
+	if (AWarriorTargetingService* Targeting = AWarriorWorldService::Get<AWarriorTargetingService>(this, false))
+	{
+		Targeting->UnregisterWarrior(this);
+	}
+	if (AWarriorStreamingGrid* Grid = AWarriorWorldService::Get<AWarriorStreamingGrid>(this, false))
+	{
+		Grid->UnregisterWarrior(this);
+	}
+	if (AWarriorSquadService* Squads = AWarriorWorldService::Get<AWarriorSquadService>(this, false))
+	{
+		Squads->RemoveFromSquad(this);
+	}
+	if (AWarriorStatusEffectService* StatusEffects = AWarriorWorldService::Get<AWarriorStatusEffectService>(this, false))
+	{
+		StatusEffects->ClearEffects(this);
+	}
+	if (AWarriorNavigationService* Navigation = AWarriorWorldService::Get<AWarriorNavigationService>(this, false))
+	{
+		Navigation->StopChasing(this);
+	}
+}
+
+void AWarriorCombatCharacter::PublishComboState()
+{
+	if (ComboState)
+	{
+		ComboState->Update(this);
+	}
+}
+
+bool AWarriorCombatCharacter::ReturnTeam()
+{
+	return true;
+}
\ No newline at end of file
@@ -0,0 +1,52 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorComboState.h"
+#include "WarriorCombatCharacter.h"
+#include "GameFramework/Controller.h"
+#include "UnrealNetwork.h"
+
+AWarriorComboState::AWarriorComboState()
+{
+	bReplicates = true;
+	bAlwaysRelevant = false;
+	NetUpdateFrequency = 10.f;
+	NetDormancy = DORM_DormantAll;
+
+	Warrior = nullptr;
+	Team = false;
+	AttackCount = 0;
+	bIsAttacking = false;
+	bVolleyReady = false;
+}
+
+void AWarriorComboState::Update(const AWarriorCombatCharacter* InWarrior)
+{
+	if (AttackCount == InWarrior->AttackCount && bIsAttacking == InWarrior->IsAttacking && bVolleyReady == InWarrior->AttackOnOff)
+	{
+		return;
+	}
+
+	AttackCount = InWarrior->AttackCount;
+	bIsAttacking = InWarrior->IsAttacking;
+	bVolleyReady = InWarrior->AttackOnOff;
+	FlushNetDormancy();
+}
+
+bool AWarriorComboState::IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const
+{
+	const AController* Controller = Cast<AController>(RealViewer);
+	const AWarriorCombatCharacter* Viewer = Cast<AWarriorCombatCharacter>(Controller ? Controller->GetPawn() : ViewTarget);
+	return Viewer && Viewer->Team == Team;
+}
+
+void AWarriorComboState::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AWarriorComboState, Warrior);
+	DOREPLIFETIME_CONDITION(AWarriorComboState, Team, COND_InitialOnly);
+	DOREPLIFETIME(AWarriorComboState, AttackCount);
+	DOREPLIFETIME(AWarriorComboState, bIsAttacking);
+	DOREPLIFETIME(AWarriorComboState, bVolleyReady);
+}
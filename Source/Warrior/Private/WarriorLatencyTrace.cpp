@@ -0,0 +1,283 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorLatencyTrace.h"
+#include "Warrior.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Runtime/Launch/Resources/Version.h"
+
+#if ENGINE_MAJOR_VERSION > 4 || ENGINE_MINOR_VERSION >= 25
+#include "ProfilingDebugging/MiscTrace.h"
+#define WARRIOR_LATENCY_BOOKMARK(Format, ...) TRACE_BOOKMARK(Format, ##__VA_ARGS__)
+#else
+// No Unreal Insights, the CSV profiler stats are the timeline view
+#define WARRIOR_LATENCY_BOOKMARK(Format, ...)
+#endif
+
+CSV_DEFINE_CATEGORY(WarriorLatency, true);
+
+bool FWarriorLatencyTrace::bTracing = false;
+
+namespace WarriorLatency
+{
+	/** One segment per pair of consecutive stages, plus input to damage */
+	static const int32 NumSegments = (int32)EWarriorLatencyStage::Count;
+	static const int32 TotalSegment = NumSegments - 1;
+
+	/** Upper bounds of the millisecond buckets, the last bucket takes everything above */
+	static const float MsBounds[] = { 1.f, 2.f, 4.f, 8.f, 16.7f, 33.3f, 50.f, 66.7f, 100.f, 150.f, 200.f, 300.f, 500.f, 1000.f };
+	static const int32 NumMsBuckets = ARRAY_COUNT(MsBounds) + 1;
+
+	/** One bucket per frame count, the last bucket takes everything above */
+	static const int32 NumFrameBuckets = 17;
+
+	/** Traces that never reach damage (missed arrows) are dropped after this */
+	static const double TraceTimeout = 10.0;
+
+	struct FTrace
+	{
+		uint64 Cycles[(int32)EWarriorLatencyStage::Count];
+		uint64 Frames[(int32)EWarriorLatencyStage::Count];
+		uint8 StageMask = 0;
+	};
+
+	struct FHistogram
+	{
+		int32 MsCounts[NumMsBuckets] = {};
+		int32 FrameCounts[NumFrameBuckets] = {};
+		int32 NumSamples = 0;
+		double TotalMs = 0.0;
+		double MaxMs = 0.0;
+		uint64 TotalFrames = 0;
+
+		void Add(double Ms, uint64 NumFrames)
+		{
+			int32 Bucket = 0;
+			while (Bucket < NumMsBuckets - 1 && Ms > MsBounds[Bucket])
+			{
+				++Bucket;
+			}
+			++MsCounts[Bucket];
+			++FrameCounts[FMath::Min<uint64>(NumFrames, NumFrameBuckets - 1)];
+			++NumSamples;
+			TotalMs += Ms;
+			MaxMs = FMath::Max(MaxMs, Ms);
+			TotalFrames += NumFrames;
+		}
+
+		/** Upper bound of the bucket holding the given fraction of the samples */
+		float GetPercentileMs(float Fraction) const
+		{
+			const int32 Rank = FMath::CeilToInt(NumSamples * Fraction);
+			int32 Seen = 0;
+			for (int32 Bucket = 0; Bucket < NumMsBuckets - 1; ++Bucket)
+			{
+				Seen += MsCounts[Bucket];
+				if (Seen >= Rank)
+				{
+					return MsBounds[Bucket];
+				}
+			}
+			return (float)MaxMs;
+		}
+	};
+
+	static TMap<uint32, FTrace> Traces;
+	static FHistogram Histograms[NumSegments];
+	static uint32 NextTraceId = 1;
+	static FString CsvPath;
+
+	static void AddSample(int32 Segment, const FTrace& Trace, EWarriorLatencyStage From, EWarriorLatencyStage To)
+	{
+		const double Ms = FPlatformTime::ToMilliseconds64(Trace.Cycles[(int32)To] - Trace.Cycles[(int32)From]);
+		Histograms[Segment].Add(Ms, Trace.Frames[(int32)To] - Trace.Frames[(int32)From]);
+	}
+
+	static void DropStaleTraces()
+	{
+		const uint64 Now = FPlatformTime::Cycles64();
+		for (auto It = Traces.CreateIterator(); It; ++It)
+		{
+			if (FPlatformTime::ToSeconds64(Now - It.Value().Cycles[(int32)EWarriorLatencyStage::Input]) > TraceTimeout)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void FWarriorLatencyTrace::Start(const FString& Path)
+{
+	using namespace WarriorLatency;
+
+	Traces.Reset();
+	for (FHistogram& Histogram : Histograms)
+	{
+		Histogram = FHistogram();
+	}
+	CsvPath = Path.IsEmpty()
+		? FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorLatency-%s.csv"), *FDateTime::Now().ToString())
+		: Path;
+	bTracing = true;
+	UE_LOG(LogWarrior, Log, TEXT("Tracing attack latency, histograms go to %s"), *CsvPath);
+}
+
+void FWarriorLatencyTrace::Stop()
+{
+	if (!bTracing)
+	{
+		return;
+	}
+	bTracing = false;
+
+	LogReport();
+	ExportCsv(WarriorLatency::CsvPath);
+	WarriorLatency::Traces.Reset();
+}
+
+uint32 FWarriorLatencyTrace::BeginTraceInternal()
+{
+	using namespace WarriorLatency;
+
+	// Every so often, so arrows that missed don't pile up
+	if ((NextTraceId & 255) == 0)
+	{
+		DropStaleTraces();
+	}
+
+	const uint32 TraceId = NextTraceId++;
+	if (NextTraceId == 0)
+	{
+		NextTraceId = 1;
+	}
+
+	FTrace& Trace = Traces.Add(TraceId);
+	Trace.Cycles[(int32)EWarriorLatencyStage::Input] = FPlatformTime::Cycles64();
+	Trace.Frames[(int32)EWarriorLatencyStage::Input] = GFrameCounter;
+	Trace.StageMask = 1 << (int32)EWarriorLatencyStage::Input;
+	return TraceId;
+}
+
+void FWarriorLatencyTrace::MarkInternal(uint32 TraceId, EWarriorLatencyStage Stage)
+{
+	using namespace WarriorLatency;
+
+	FTrace* Trace = Traces.Find(TraceId);
+	const uint8 StageBit = 1 << (int32)Stage;
+	if (Trace == nullptr || (Trace->StageMask & StageBit) != 0)
+	{
+		return;
+	}
+
+	Trace->Cycles[(int32)Stage] = FPlatformTime::Cycles64();
+	Trace->Frames[(int32)Stage] = GFrameCounter;
+	Trace->StageMask |= StageBit;
+
+	// Segment ending at this stage, if the previous stage was seen
+	const int32 Previous = (int32)Stage - 1;
+	if (Previous >= 0 && (Trace->StageMask & (1 << Previous)) != 0)
+	{
+		AddSample(Previous, *Trace, (EWarriorLatencyStage)Previous, Stage);
+	}
+
+	if (Stage == EWarriorLatencyStage::DamageApplied)
+	{
+		AddSample(TotalSegment, *Trace, EWarriorLatencyStage::Input, Stage);
+
+		const double TotalMs = FPlatformTime::ToMilliseconds64(Trace->Cycles[(int32)Stage] - Trace->Cycles[(int32)EWarriorLatencyStage::Input]);
+		CSV_CUSTOM_STAT(WarriorLatency, InputToDamageMs, (float)TotalMs, ECsvCustomStatOp::Max);
+		CSV_CUSTOM_STAT(WarriorLatency, Hits, 1, ECsvCustomStatOp::Accumulate);
+		WARRIOR_LATENCY_BOOKMARK(TEXT("Warrior hit %u: %.1f ms"), TraceId, TotalMs);
+
+		Traces.Remove(TraceId);
+	}
+	else if (Stage == EWarriorLatencyStage::ArrowSpawned && (Trace->StageMask & (1 << (int32)EWarriorLatencyStage::AttackStarted)) != 0)
+	{
+		const double Ms = FPlatformTime::ToMilliseconds64(Trace->Cycles[(int32)Stage] - Trace->Cycles[(int32)EWarriorLatencyStage::AttackStarted]);
+		CSV_CUSTOM_STAT(WarriorLatency, AttackToSpawnMs, (float)Ms, ECsvCustomStatOp::Max);
+	}
+}
+
+void FWarriorLatencyTrace::LogReport()
+{
+	using namespace WarriorLatency;
+
+	UE_LOG(LogWarrior, Log, TEXT("%-14s %8s %8s %8s %8s %8s %9s"), TEXT("Segment"), TEXT("Samples"), TEXT("AvgMs"), TEXT("P50Ms"), TEXT("P95Ms"), TEXT("MaxMs"), TEXT("AvgFrames"));
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const FHistogram& Histogram = Histograms[Segment];
+		if (Histogram.NumSamples == 0)
+		{
+			UE_LOG(LogWarrior, Log, TEXT("%-14s %8d"), GetSegmentName(Segment), 0);
+			continue;
+		}
+		UE_LOG(LogWarrior, Log, TEXT("%-14s %8d %8.2f %8.1f %8.1f %8.2f %9.2f"), GetSegmentName(Segment), Histogram.NumSamples,
+			Histogram.TotalMs / Histogram.NumSamples, Histogram.GetPercentileMs(0.5f), Histogram.GetPercentileMs(0.95f),
+			Histogram.MaxMs, (double)Histogram.TotalFrames / Histogram.NumSamples);
+	}
+}
+
+bool FWarriorLatencyTrace::ExportCsv(const FString& Path)
+{
+	using namespace WarriorLatency;
+
+	FString Csv = TEXT("Segment,Unit,Low,High,Count") LINE_TERMINATOR;
+	for (int32 Segment = 0; Segment < NumSegments; ++Segment)
+	{
+		const FHistogram& Histogram = Histograms[Segment];
+		for (int32 Bucket = 0; Bucket < NumMsBuckets; ++Bucket)
+		{
+			const float Low = Bucket > 0 ? MsBounds[Bucket - 1] : 0.f;
+			const FString High = Bucket < NumMsBuckets - 1 ? FString::SanitizeFloat(MsBounds[Bucket]) : FString(TEXT("inf"));
+			Csv += FString::Printf(TEXT("%s,ms,%s,%s,%d") LINE_TERMINATOR, GetSegmentName(Segment), *FString::SanitizeFloat(Low), *High, Histogram.MsCounts[Bucket]);
+		}
+		for (int32 Bucket = 0; Bucket < NumFrameBuckets; ++Bucket)
+		{
+			const FString High = Bucket < NumFrameBuckets - 1 ? FString::FromInt(Bucket) : FString(TEXT("inf"));
+			Csv += FString::Printf(TEXT("%s,frames,%d,%s,%d") LINE_TERMINATOR, GetSegmentName(Segment), Bucket, *High, Histogram.FrameCounts[Bucket]);
+		}
+	}
+
+	if (!FFileHelper::SaveStringToFile(Csv, *Path))
+	{
+		UE_LOG(LogWarrior, Warning, TEXT("Could not write the latency histograms to %s"), *Path);
+		return false;
+	}
+	UE_LOG(LogWarrior, Log, TEXT("Latency histograms written to %s"), *Path);
+	return true;
+}
+
+const TCHAR* FWarriorLatencyTrace::GetSegmentName(int32 Segment)
+{
+	switch (Segment)
+	{
+	case 0:		return TEXT("InputToAttack");
+	case 1:		return TEXT("AttackToSpawn");
+	case 2:		return TEXT("Flight");
+	case 3:		return TEXT("HitToDamage");
+	case 4:		return TEXT("InputToDamage");
+	default:	return TEXT("Unknown");
+	}
+}
+
+static FAutoConsoleCommand WarriorLatencyStartCommand(
+	TEXT("Warrior.Latency.Start"),
+	TEXT("Starts tracing attack input to hit latency. Optional argument: CSV file written on stop"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FWarriorLatencyTrace::Start(Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+static FAutoConsoleCommand WarriorLatencyStopCommand(
+	TEXT("Warrior.Latency.Stop"),
+	TEXT("Stops tracing attack latency, prints the report and writes the CSV"),
+	FConsoleCommandDelegate::CreateStatic(&FWarriorLatencyTrace::Stop));
+
+static FAutoConsoleCommand WarriorLatencyReportCommand(
+	TEXT("Warrior.Latency.Report"),
+	TEXT("Prints the attack latency per stage in milliseconds and frames"),
+	FConsoleCommandDelegate::CreateStatic(&FWarriorLatencyTrace::LogReport));
@@ -0,0 +1,171 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorLoadStats.h"
+#include "Warrior.h"
+#include "Engine/World.h"
+#include "Engine/NetDriver.h"
+#include "Engine/NetConnection.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/CommandLine.h"
+#include "Misc/CoreDelegates.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+FWarriorServerLoadStats::FWarriorServerLoadStats(float InReportInterval, const FString& InCsvPath)
+	: ReportInterval(InReportInterval)
+	, CsvPath(InCsvPath)
+	, FrameStartTime(0.0)
+	, ActorTickEndTime(0.0)
+	, LastReportTime(FPlatformTime::Seconds())
+	, NumFrames(0)
+	, TotalFrameMs(0.0)
+	, MaxFrameMs(0.0)
+	, TotalGameTickMs(0.0)
+	, TotalReplicationMs(0.0)
+	, NumConnectionSamples(0)
+	, TotalConnectionOutBytes(0.0)
+	, TotalConnectionInBytes(0.0)
+	, MaxConnectionOutBytes(0)
+{
+	PreActorTickHandle = FWorldDelegates::OnWorldPreActorTick.AddRaw(this, &FWarriorServerLoadStats::OnWorldPreActorTick);
+	PostActorTickHandle = FWorldDelegates::OnWorldPostActorTick.AddRaw(this, &FWarriorServerLoadStats::OnWorldPostActorTick);
+	EndFrameHandle = FCoreDelegates::OnEndFrame.AddRaw(this, &FWarriorServerLoadStats::OnEndFrame);
+
+	if (!IFileManager::Get().FileExists(*CsvPath))
+	{
+		FFileHelper::SaveStringToFile(FString(GetCsvHeader()) + LINE_TERMINATOR, *CsvPath);
+	}
+}
+
+FWarriorServerLoadStats::~FWarriorServerLoadStats()
+{
+	FWorldDelegates::OnWorldPreActorTick.Remove(PreActorTickHandle);
+	FWorldDelegates::OnWorldPostActorTick.Remove(PostActorTickHandle);
+	FCoreDelegates::OnEndFrame.Remove(EndFrameHandle);
+}
+
+TUniquePtr<FWarriorServerLoadStats> FWarriorServerLoadStats::CreateFromCommandLine()
+{
+	if (!FParse::Param(FCommandLine::Get(), TEXT("WarriorLoadTest")))
+	{
+		return nullptr;
+	}
+
+	float ReportInterval = 5.f;
+	FParse::Value(FCommandLine::Get(), TEXT("WarriorLoadInterval="), ReportInterval);
+
+	FString CsvPath = FPaths::ProfilingDir() / TEXT("WarriorLoadTest.csv");
+	FParse::Value(FCommandLine::Get(), TEXT("WarriorLoadCsv="), CsvPath);
+
+	UE_LOG(LogWarrior, Log, TEXT("Server load stats every %.1fs to %s"), ReportInterval, *CsvPath);
+	return MakeUnique<FWarriorServerLoadStats>(ReportInterval, CsvPath);
+}
+
+const TCHAR* FWarriorServerLoadStats::GetCsvHeader()
+{
+	return TEXT("Seconds,Players,Connections,AvgFrameMs,MaxFrameMs,AvgGameTickMs,AvgReplicationMs,ReplicationUsPerPlayer,AvgConnOutBytesPerSec,MaxConnOutBytesPerSec,AvgConnInBytesPerSec,UsedPhysicalMB");
+}
+
+void FWarriorServerLoadStats::OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World->GetNetMode() != NM_DedicatedServer && World->GetNetMode() != NM_ListenServer)
+	{
+		return;
+	}
+	MeasuredWorld = World;
+	FrameStartTime = FPlatformTime::Seconds();
+}
+
+void FWarriorServerLoadStats::OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds)
+{
+	if (World == MeasuredWorld.Get())
+	{
+		ActorTickEndTime = FPlatformTime::Seconds();
+	}
+}
+
+void FWarriorServerLoadStats::OnEndFrame()
+{
+	UWorld* World = MeasuredWorld.Get();
+	if (World == nullptr || FrameStartTime <= 0.0 || ActorTickEndTime < FrameStartTime)
+	{
+		return;
+	}
+
+	// The net driver flushes right after the post actor tick broadcast, on a dedicated server
+	// this is what dominates the rest of the frame
+	const double Now = FPlatformTime::Seconds();
+	const double FrameMs = (Now - FrameStartTime) * 1000.0;
+	++NumFrames;
+	TotalFrameMs += FrameMs;
+	MaxFrameMs = FMath::Max(MaxFrameMs, FrameMs);
+	TotalGameTickMs += (ActorTickEndTime - FrameStartTime) * 1000.0;
+	TotalReplicationMs += (Now - ActorTickEndTime) * 1000.0;
+	FrameStartTime = 0.0;
+
+	if (Now - LastReportTime >= ReportInterval)
+	{
+		SampleConnections(World);
+		WriteReport(World);
+		LastReportTime = Now;
+	}
+}
+
+void FWarriorServerLoadStats::SampleConnections(UWorld* World)
+{
+	UNetDriver* NetDriver = World->GetNetDriver();
+	if (NetDriver == nullptr)
+	{
+		return;
+	}
+
+	// The per second counters are refreshed by the net driver itself
+	for (UNetConnection* Connection : NetDriver->ClientConnections)
+	{
+		if (Connection)
+		{
+			++NumConnectionSamples;
+			TotalConnectionOutBytes += Connection->OutBytesPerSecond;
+			TotalConnectionInBytes += Connection->InBytesPerSecond;
+			MaxConnectionOutBytes = FMath::Max(MaxConnectionOutBytes, Connection->OutBytesPerSecond);
+		}
+	}
+}
+
+void FWarriorServerLoadStats::WriteReport(UWorld* World)
+{
+	const int32 NumPlayers = World->GetNumPlayerControllers();
+	const int32 NumConnections = World->GetNetDriver() ? World->GetNetDriver()->ClientConnections.Num() : 0;
+	const double Frames = FMath::Max(NumFrames, 1);
+	const double Samples = FMath::Max(NumConnectionSamples, 1);
+	const double AvgReplicationMs = TotalReplicationMs / Frames;
+	const double UsedMB = FPlatformMemory::GetStats().UsedPhysical / (1024.0 * 1024.0);
+
+	const FString Row = FString::Printf(TEXT("%.1f,%d,%d,%.3f,%.3f,%.3f,%.3f,%.2f,%.0f,%d,%.0f,%.1f"),
+		World->GetRealTimeSeconds(),
+		NumPlayers,
+		NumConnections,
+		TotalFrameMs / Frames,
+		MaxFrameMs,
+		TotalGameTickMs / Frames,
+		AvgReplicationMs,
+		NumPlayers > 0 ? AvgReplicationMs * 1000.0 / NumPlayers : 0.0,
+		TotalConnectionOutBytes / Samples,
+		MaxConnectionOutBytes,
+		TotalConnectionInBytes / Samples,
+		UsedMB);
+
+	UE_LOG(LogWarrior, Log, TEXT("LoadStats %s"), *Row);
+	FFileHelper::SaveStringToFile(Row + LINE_TERMINATOR, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+
+	NumFrames = 0;
+	TotalFrameMs = 0.0;
+	MaxFrameMs = 0.0;
+	TotalGameTickMs = 0.0;
+	TotalReplicationMs = 0.0;
+	NumConnectionSamples = 0;
+	TotalConnectionOutBytes = 0.0;
+	TotalConnectionInBytes = 0.0;
+	MaxConnectionOutBytes = 0;
+}
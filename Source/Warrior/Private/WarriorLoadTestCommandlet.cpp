@@ -0,0 +1,211 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorLoadTestCommandlet.h"
+#include "Warrior.h"
+#include "WarriorProcessUtils.h"
+#include "HAL/FileManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UWarriorLoadTestCommandlet::UWarriorLoadTestCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UWarriorLoadTestCommandlet::Main(const FString& Params)
+{
+	FString Map;
+	if (!FParse::Value(*Params, TEXT("Map="), Map))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorLoadTest: -Map= is required"));
+		return 1;
+	}
+
+	int32 MinPlayers = 10;
+	int32 MaxPlayers = 200;
+	int32 Step = 10;
+	int32 BotsPerProcess = 10;
+	int32 Port = 7777;
+	float StepSeconds = 30.f;
+	float ServerStartupSeconds = 20.f;
+	float BudgetMs = 1000.f / 30.f;
+	FString Behavior = TEXT("Random");
+	FParse::Value(*Params, TEXT("MinPlayers="), MinPlayers);
+	FParse::Value(*Params, TEXT("MaxPlayers="), MaxPlayers);
+	FParse::Value(*Params, TEXT("Step="), Step);
+	FParse::Value(*Params, TEXT("BotsPerProcess="), BotsPerProcess);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("StepSeconds="), StepSeconds);
+	FParse::Value(*Params, TEXT("ServerStartupSeconds="), ServerStartupSeconds);
+	FParse::Value(*Params, TEXT("BudgetMs="), BudgetMs);
+	FParse::Value(*Params, TEXT("Behavior="), Behavior);
+	Step = FMath::Max(Step, 1);
+	BotsPerProcess = FMath::Max(BotsPerProcess, 1);
+
+	const FString ProjectFile = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	const FString CsvPrefix = FPaths::ConvertRelativePathToFull(FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorLoadTest-%s"), *FDateTime::Now().ToString()));
+	const float ReportInterval = FMath::Max(StepSeconds / 6.f, 1.f);
+
+	// Ramps the bots up against a fresh server, samples go to CsvPath
+	auto RunRamp = [&](const TCHAR* ServerArgs, const FString& CsvPath)
+	{
+		FProcHandle Server = WarriorProcessUtils::Launch(FString::Printf(
+			TEXT("\"%s\" %s?MaxPlayers=%d -server -nullrhi -nosound -unattended -log -port=%d -WarriorLoadTest -WarriorLoadCsv=\"%s\" -WarriorLoadInterval=%.1f %s"),
+			*ProjectFile, *Map, MaxPlayers + BotsPerProcess, Port, *CsvPath, ReportInterval, ServerArgs));
+		if (!Server.IsValid())
+		{
+			UE_LOG(LogWarrior, Error, TEXT("WarriorLoadTest: could not start the server"));
+			return false;
+		}
+		FPlatformProcess::Sleep(ServerStartupSeconds);
+
+		TArray<FProcHandle> Clients;
+		int32 NumBots = 0;
+		int32 ProcessIndex = 0;
+		for (int32 Target = MinPlayers; Target <= MaxPlayers && FPlatformProcess::IsProcRunning(Server); Target += Step)
+		{
+			while (NumBots < Target)
+			{
+				const int32 Bots = FMath::Min(BotsPerProcess, Target - NumBots);
+				Clients.Add(WarriorProcessUtils::Launch(FString::Printf(
+					TEXT("\"%s\" 127.0.0.1:%d -game -nullrhi -nosound -unattended -WarriorBots=%d -WarriorBotBehavior=%s -WarriorBotSeed=%d"),
+					*ProjectFile, Port, Bots, *Behavior, ProcessIndex++)));
+				NumBots += Bots;
+			}
+
+			UE_LOG(LogWarrior, Display, TEXT("WarriorLoadTest: %d bots in %d processes, measuring for %.0fs"), NumBots, Clients.Num(), StepSeconds);
+			FPlatformProcess::Sleep(StepSeconds);
+		}
+
+		WarriorProcessUtils::Terminate(Clients);
+		TArray<FProcHandle> ServerProcess;
+		ServerProcess.Add(Server);
+		WarriorProcessUtils::Terminate(ServerProcess);
+		return true;
+	};
+
+	const FString CsvPath = CsvPrefix + TEXT(".csv");
+	if (!RunRamp(TEXT(""), CsvPath))
+	{
+		return 1;
+	}
+	Summarize(CsvPath, BudgetMs);
+
+	// Same ramp without the replication graph
+	if (FParse::Param(*Params, TEXT("CompareReplicationGraph")))
+	{
+		const FString LegacyCsvPath = CsvPrefix + TEXT("-NoRepGraph.csv");
+		if (!RunRamp(TEXT("-WarriorNoRepGraph"), LegacyCsvPath))
+		{
+			return 1;
+		}
+		UE_LOG(LogWarrior, Display, TEXT("Without the replication graph:"));
+		Summarize(LegacyCsvPath, BudgetMs);
+		CompareReplication(CsvPath, LegacyCsvPath);
+	}
+
+	return 0;
+}
+
+void UWarriorLoadTestCommandlet::Summarize(const FString& CsvPath, float BudgetMs) const
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *CsvPath) || Lines.Num() < 2)
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorLoadTest: no samples in %s"), *CsvPath);
+		return;
+	}
+
+	struct FPlayerCountSummary
+	{
+		int32 NumRows = 0;
+		double FrameMs = 0.0;
+		double MaxFrameMs = 0.0;
+		double ReplicationMs = 0.0;
+		double ConnOutBytes = 0.0;
+		double UsedMB = 0.0;
+	};
+	TMap<int32, FPlayerCountSummary> ByPlayers;
+
+	// Columns as written by FWarriorServerLoadStats
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		TArray<FString> Columns;
+		if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) < 12)
+		{
+			continue;
+		}
+		FPlayerCountSummary& Summary = ByPlayers.FindOrAdd(FCString::Atoi(*Columns[1]));
+		++Summary.NumRows;
+		Summary.FrameMs += FCString::Atod(*Columns[3]);
+		Summary.MaxFrameMs = FMath::Max(Summary.MaxFrameMs, FCString::Atod(*Columns[4]));
+		Summary.ReplicationMs += FCString::Atod(*Columns[6]);
+		Summary.ConnOutBytes += FCString::Atod(*Columns[8]);
+		Summary.UsedMB += FCString::Atod(*Columns[11]);
+	}
+	ByPlayers.KeySort(TLess<int32>());
+
+	UE_LOG(LogWarrior, Display, TEXT("Players  FrameMs  MaxFrameMs  ReplicationMs  ConnOutKB/s  UsedMB"));
+	int32 PlayerCap = 0;
+	for (const TPair<int32, FPlayerCountSummary>& Pair : ByPlayers)
+	{
+		const FPlayerCountSummary& Summary = Pair.Value;
+		const double FrameMs = Summary.FrameMs / Summary.NumRows;
+		UE_LOG(LogWarrior, Display, TEXT("%7d  %7.2f  %10.2f  %13.2f  %11.1f  %6.0f"),
+			Pair.Key, FrameMs, Summary.MaxFrameMs, Summary.ReplicationMs / Summary.NumRows,
+			Summary.ConnOutBytes / Summary.NumRows / 1024.0, Summary.UsedMB / Summary.NumRows);
+		if (FrameMs <= BudgetMs)
+		{
+			PlayerCap = FMath::Max(PlayerCap, Pair.Key);
+		}
+	}
+
+	UE_LOG(LogWarrior, Display, TEXT("Largest player count within %.1fms per frame on one core: %d (samples in %s)"), BudgetMs, PlayerCap, *CsvPath);
+}
+
+TMap<int32, double> UWarriorLoadTestCommandlet::ReadReplicationMs(const FString& CsvPath)
+{
+	TMap<int32, double> Sums;
+	TMap<int32, int32> Counts;
+
+	TArray<FString> Lines;
+	FFileHelper::LoadFileToStringArray(Lines, *CsvPath);
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		TArray<FString> Columns;
+		if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) < 12)
+		{
+			continue;
+		}
+		const int32 Players = FCString::Atoi(*Columns[1]);
+		Sums.FindOrAdd(Players) += FCString::Atod(*Columns[6]);
+		++Counts.FindOrAdd(Players);
+	}
+
+	for (TPair<int32, double>& Pair : Sums)
+	{
+		Pair.Value /= Counts[Pair.Key];
+	}
+	Sums.KeySort(TLess<int32>());
+	return Sums;
+}
+
+void UWarriorLoadTestCommandlet::CompareReplication(const FString& GraphCsvPath, const FString& LegacyCsvPath) const
+{
+	const TMap<int32, double> Graph = ReadReplicationMs(GraphCsvPath);
+	const TMap<int32, double> Legacy = ReadReplicationMs(LegacyCsvPath);
+
+	UE_LOG(LogWarrior, Display, TEXT("Players  RepGraphMs  LegacyMs  Speedup"));
+	for (const TPair<int32, double>& Pair : Graph)
+	{
+		if (const double* LegacyMs = Legacy.Find(Pair.Key))
+		{
+			UE_LOG(LogWarrior, Display, TEXT("%7d  %10.2f  %8.2f  %6.1fx"),
+				Pair.Key, Pair.Value, *LegacyMs, Pair.Value > 0.0 ? *LegacyMs / Pair.Value : 0.0);
+		}
+	}
+}
@@ -0,0 +1,140 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorMemoryReportCommandlet.h"
+#include "Warrior.h"
+#include "WarriorProcessUtils.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+UWarriorMemoryReportCommandlet::UWarriorMemoryReportCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UWarriorMemoryReportCommandlet::Main(const FString& Params)
+{
+	FString Map;
+	if (!FParse::Value(*Params, TEXT("Map="), Map))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorMemoryReport: -Map= is required"));
+		return 1;
+	}
+
+	int32 Players = 50;
+	int32 BotsPerProcess = 10;
+	int32 Port = 7777;
+	float Seconds = 120.f;
+	float Interval = 5.f;
+	float ServerStartupSeconds = 20.f;
+	float BudgetMB = 0.f;
+	FParse::Value(*Params, TEXT("Players="), Players);
+	FParse::Value(*Params, TEXT("BotsPerProcess="), BotsPerProcess);
+	FParse::Value(*Params, TEXT("Port="), Port);
+	FParse::Value(*Params, TEXT("Seconds="), Seconds);
+	FParse::Value(*Params, TEXT("Interval="), Interval);
+	FParse::Value(*Params, TEXT("ServerStartupSeconds="), ServerStartupSeconds);
+	FParse::Value(*Params, TEXT("BudgetMB="), BudgetMB);
+	BotsPerProcess = FMath::Max(BotsPerProcess, 1);
+
+	const FString ProjectFile = FPaths::ConvertRelativePathToFull(FPaths::GetProjectFilePath());
+	const FString CsvPath = FPaths::ConvertRelativePathToFull(FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorMemory-%s.csv"), *FDateTime::Now().ToString()));
+
+	FProcHandle Server = WarriorProcessUtils::Launch(FString::Printf(
+		TEXT("\"%s\" %s?MaxPlayers=%d -server -nullrhi -nosound -unattended -log -port=%d -LLM -LLMCSV -WarriorMemoryCsv=\"%s\" -WarriorMemoryInterval=%.1f"),
+		*ProjectFile, *Map, Players + BotsPerProcess, Port, *CsvPath, Interval));
+	if (!Server.IsValid())
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorMemoryReport: could not start the server"));
+		return 1;
+	}
+	FPlatformProcess::Sleep(ServerStartupSeconds);
+
+	TArray<FProcHandle> Processes;
+	int32 ProcessIndex = 0;
+	for (int32 NumBots = 0; NumBots < Players; )
+	{
+		const int32 Bots = FMath::Min(BotsPerProcess, Players - NumBots);
+		Processes.Add(WarriorProcessUtils::Launch(FString::Printf(
+			TEXT("\"%s\" 127.0.0.1:%d -game -nullrhi -nosound -unattended -WarriorBots=%d -WarriorBotSeed=%d"),
+			*ProjectFile, Port, Bots, ProcessIndex++)));
+		NumBots += Bots;
+	}
+
+	UE_LOG(LogWarrior, Display, TEXT("WarriorMemoryReport: %d bots in %d processes, sampling for %.0fs"), Players, Processes.Num(), Seconds);
+	FPlatformProcess::Sleep(Seconds);
+
+	Processes.Add(Server);
+	WarriorProcessUtils::Terminate(Processes);
+
+	return Summarize(CsvPath, BudgetMB) ? 0 : 1;
+}
+
+bool UWarriorMemoryReportCommandlet::Summarize(const FString& CsvPath, float BudgetMB) const
+{
+	TArray<FString> Lines;
+	if (!FFileHelper::LoadFileToStringArray(Lines, *CsvPath) || Lines.Num() < 2)
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorMemoryReport: no samples in %s"), *CsvPath);
+		return false;
+	}
+
+	struct FClassSummary
+	{
+		int32 Peak = 0;
+		double PeakKB = 0.0;
+		int32 FinalLive = 0;
+		int64 Spawned = 0;
+		double MaxSpawnedPerSec = 0.0;
+		double MaxDestroyedPerSec = 0.0;
+		int32 MaxOverdue = 0;
+	};
+	TMap<FString, FClassSummary> ByClass;
+
+	// Columns as written by FWarriorMemoryTracker, rows are in time order
+	for (int32 LineIndex = 1; LineIndex < Lines.Num(); ++LineIndex)
+	{
+		TArray<FString> Columns;
+		if (Lines[LineIndex].ParseIntoArray(Columns, TEXT(",")) < 11)
+		{
+			continue;
+		}
+		FClassSummary& Summary = ByClass.FindOrAdd(Columns[1]);
+		Summary.Peak = FMath::Max(Summary.Peak, FCString::Atoi(*Columns[3]));
+		Summary.PeakKB = FMath::Max(Summary.PeakKB, FCString::Atod(*Columns[5]));
+		Summary.FinalLive = FCString::Atoi(*Columns[2]);
+		Summary.Spawned = FCString::Atoi64(*Columns[6]);
+		Summary.MaxSpawnedPerSec = FMath::Max(Summary.MaxSpawnedPerSec, FCString::Atod(*Columns[8]));
+		Summary.MaxDestroyedPerSec = FMath::Max(Summary.MaxDestroyedPerSec, FCString::Atod(*Columns[9]));
+		Summary.MaxOverdue = FMath::Max(Summary.MaxOverdue, FCString::Atoi(*Columns[10]));
+	}
+
+	bool bPassed = true;
+	double TotalPeakKB = 0.0;
+	UE_LOG(LogWarrior, Display, TEXT("Class    PeakLive  PeakKB  FinalLive  Spawned  MaxSpawn/s  MaxDestroy/s  MaxOverdue"));
+	for (const TPair<FString, FClassSummary>& Pair : ByClass)
+	{
+		const FClassSummary& Summary = Pair.Value;
+		UE_LOG(LogWarrior, Display, TEXT("%-8s %8d  %6.0f  %9d  %7lld  %10.1f  %12.1f  %10d"),
+			*Pair.Key, Summary.Peak, Summary.PeakKB, Summary.FinalLive, Summary.Spawned,
+			Summary.MaxSpawnedPerSec, Summary.MaxDestroyedPerSec, Summary.MaxOverdue);
+		TotalPeakKB += Summary.PeakKB;
+		if (Summary.MaxOverdue > 0)
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("WarriorMemoryReport: up to %d %s actors outlived their InitialLifeSpan"), Summary.MaxOverdue, *Pair.Key);
+			bPassed = false;
+		}
+	}
+
+	// Per class peaks may not coincide, their sum is an upper bound
+	UE_LOG(LogWarrior, Display, TEXT("Sum of the peaks: %.1f MB (samples in %s)"), TotalPeakKB / 1024.0, *CsvPath);
+	if (BudgetMB > 0.f && TotalPeakKB / 1024.0 > BudgetMB)
+	{
+		UE_LOG(LogWarrior, Warning, TEXT("WarriorMemoryReport: over the %.1f MB budget"), BudgetMB);
+		bPassed = false;
+	}
+	return bPassed;
+}
@@ -0,0 +1,261 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorMemoryTracker.h"
+#include "Warrior.h"
+#include "GameFramework/Actor.h"
+#include "Engine/World.h"
+#include "Components/ActorComponent.h"
+#include "Containers/Ticker.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Paths.h"
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+DECLARE_LLM_MEMORY_STAT(TEXT("WarriorArrows"), STAT_WarriorArrowsLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("WarriorBoxes"), STAT_WarriorBoxesLLM, STATGROUP_LLMFULL);
+DECLARE_LLM_MEMORY_STAT(TEXT("WarriorWarriors"), STAT_WarriorWarriorsLLM, STATGROUP_LLMFULL);
+#endif
+
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Arrows"), STAT_WarriorLiveArrows, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Boxes"), STAT_WarriorLiveBoxes, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Live Warriors"), STAT_WarriorLiveWarriors, STATGROUP_Warrior);
+
+namespace WarriorMemory
+{
+	/** Actors get this long past their InitialLifeSpan before they count as overdue */
+	static const float OverdueGrace = 1.f;
+
+	struct FLiveActor
+	{
+		double SpawnTime;
+		float LifeSpan;
+		int64 Bytes;
+	};
+
+	struct FClassState
+	{
+		TMap<const AActor*, FLiveActor> LiveActors;
+		int32 Peak = 0;
+		int64 LiveBytes = 0;
+		int64 PeakBytes = 0;
+		int64 Spawned = 0;
+		int64 Destroyed = 0;
+		/** Since the last report */
+		int32 IntervalSpawned = 0;
+		int32 IntervalDestroyed = 0;
+	};
+
+	static FClassState States[(int32)EWarriorMemoryClass::Count];
+
+	/** Bytes per instance, measured on the first instance of each class */
+	static TMap<const UClass*, int64> InstanceBytes;
+
+	static double IntervalStart = FPlatformTime::Seconds();
+
+	static FString CsvPath;
+	static double CsvStartTime = 0.0;
+	static FDelegateHandle CsvTickerHandle;
+
+	static int64 MeasureInstance(AActor* Actor)
+	{
+		if (const int64* Bytes = InstanceBytes.Find(Actor->GetClass()))
+		{
+			return *Bytes;
+		}
+
+		int64 Bytes = Actor->GetClass()->GetStructureSize() + Actor->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		TInlineComponentArray<UActorComponent*> Components(Actor);
+		for (UActorComponent* Component : Components)
+		{
+			Bytes += Component->GetClass()->GetStructureSize() + Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+		}
+		InstanceBytes.Add(Actor->GetClass(), Bytes);
+		return Bytes;
+	}
+
+	static void SetLiveStat(EWarriorMemoryClass Class, int32 Live)
+	{
+		switch (Class)
+		{
+		case EWarriorMemoryClass::Arrow:	SET_DWORD_STAT(STAT_WarriorLiveArrows, Live); break;
+		case EWarriorMemoryClass::Box:		SET_DWORD_STAT(STAT_WarriorLiveBoxes, Live); break;
+		case EWarriorMemoryClass::Warrior:	SET_DWORD_STAT(STAT_WarriorLiveWarriors, Live); break;
+		default: break;
+		}
+	}
+
+	static bool WriteCsvRows(float DeltaTime)
+	{
+		FWarriorMemoryClassReport Reports[(int32)EWarriorMemoryClass::Count];
+		FWarriorMemoryTracker::BuildReport(Reports);
+
+		const double Seconds = FPlatformTime::Seconds() - CsvStartTime;
+		FString Rows;
+		for (int32 Index = 0; Index < (int32)EWarriorMemoryClass::Count; ++Index)
+		{
+			const FWarriorMemoryClassReport& Report = Reports[Index];
+			Rows += FString::Printf(TEXT("%.1f,%s,%d,%d,%.1f,%.1f,%lld,%lld,%.2f,%.2f,%d") LINE_TERMINATOR,
+				Seconds, FWarriorMemoryTracker::GetClassName((EWarriorMemoryClass)Index), Report.Live, Report.Peak,
+				Report.LiveBytes / 1024.0, Report.PeakBytes / 1024.0, Report.Spawned, Report.Destroyed,
+				Report.SpawnedPerSecond, Report.DestroyedPerSecond, Report.Overdue);
+		}
+		FFileHelper::SaveStringToFile(Rows, *CsvPath, FFileHelper::EEncodingOptions::AutoDetect, &IFileManager::Get(), FILEWRITE_Append);
+		return true;
+	}
+}
+
+void FWarriorMemoryTracker::RegisterLLMTags()
+{
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+	FLowLevelMemTracker& Tracker = FLowLevelMemTracker::Get();
+	Tracker.RegisterProjectTag((int32)EWarriorLLMTag::Arrows, TEXT("WarriorArrows"), GET_STATFNAME(STAT_WarriorArrowsLLM), NAME_None);
+	Tracker.RegisterProjectTag((int32)EWarriorLLMTag::Boxes, TEXT("WarriorBoxes"), GET_STATFNAME(STAT_WarriorBoxesLLM), NAME_None);
+	Tracker.RegisterProjectTag((int32)EWarriorLLMTag::Warriors, TEXT("WarriorWarriors"), GET_STATFNAME(STAT_WarriorWarriorsLLM), NAME_None);
+#endif
+}
+
+void FWarriorMemoryTracker::OnSpawned(EWarriorMemoryClass Class, AActor* Actor)
+{
+	// Class default objects and editor previews are not part of a battle
+	if (Actor == nullptr || Actor->GetWorld() == nullptr || !Actor->GetWorld()->IsGameWorld())
+	{
+		return;
+	}
+
+	WarriorMemory::FClassState& State = WarriorMemory::States[(int32)Class];
+	if (State.LiveActors.Contains(Actor))
+	{
+		return;
+	}
+
+	WarriorMemory::FLiveActor& Live = State.LiveActors.Add(Actor);
+	Live.SpawnTime = FPlatformTime::Seconds();
+	Live.LifeSpan = Actor->InitialLifeSpan;
+	Live.Bytes = WarriorMemory::MeasureInstance(Actor);
+
+	++State.Spawned;
+	++State.IntervalSpawned;
+	State.LiveBytes += Live.Bytes;
+	State.Peak = FMath::Max(State.Peak, State.LiveActors.Num());
+	State.PeakBytes = FMath::Max(State.PeakBytes, State.LiveBytes);
+	WarriorMemory::SetLiveStat(Class, State.LiveActors.Num());
+}
+
+void FWarriorMemoryTracker::OnDestroyed(EWarriorMemoryClass Class, const AActor* Actor)
+{
+	WarriorMemory::FClassState& State = WarriorMemory::States[(int32)Class];
+	WarriorMemory::FLiveActor Live;
+	if (!State.LiveActors.RemoveAndCopyValue(Actor, Live))
+	{
+		return;
+	}
+
+	++State.Destroyed;
+	++State.IntervalDestroyed;
+	State.LiveBytes -= Live.Bytes;
+	WarriorMemory::SetLiveStat(Class, State.LiveActors.Num());
+}
+
+void FWarriorMemoryTracker::BuildReport(FWarriorMemoryClassReport (&OutReports)[(int32)EWarriorMemoryClass::Count])
+{
+	const double Now = FPlatformTime::Seconds();
+	const float IntervalSeconds = FMath::Max((float)(Now - WarriorMemory::IntervalStart), KINDA_SMALL_NUMBER);
+	WarriorMemory::IntervalStart = Now;
+
+	for (int32 Index = 0; Index < (int32)EWarriorMemoryClass::Count; ++Index)
+	{
+		WarriorMemory::FClassState& State = WarriorMemory::States[Index];
+		FWarriorMemoryClassReport& Report = OutReports[Index];
+
+		Report.Live = State.LiveActors.Num();
+		Report.Peak = State.Peak;
+		Report.LiveBytes = State.LiveBytes;
+		Report.PeakBytes = State.PeakBytes;
+		Report.Spawned = State.Spawned;
+		Report.Destroyed = State.Destroyed;
+		Report.SpawnedPerSecond = State.IntervalSpawned / IntervalSeconds;
+		Report.DestroyedPerSecond = State.IntervalDestroyed / IntervalSeconds;
+		Report.Overdue = 0;
+		for (const TPair<const AActor*, WarriorMemory::FLiveActor>& Pair : State.LiveActors)
+		{
+			if (Pair.Value.LifeSpan > 0.f && Now - Pair.Value.SpawnTime > Pair.Value.LifeSpan + WarriorMemory::OverdueGrace)
+			{
+				++Report.Overdue;
+			}
+		}
+
+		State.IntervalSpawned = 0;
+		State.IntervalDestroyed = 0;
+	}
+}
+
+void FWarriorMemoryTracker::LogReport()
+{
+	FWarriorMemoryClassReport Reports[(int32)EWarriorMemoryClass::Count];
+	BuildReport(Reports);
+
+	UE_LOG(LogWarrior, Log, TEXT("%-8s %7s %7s %10s %10s %9s %9s %9s %9s %8s"),
+		TEXT("Class"), TEXT("Live"), TEXT("Peak"), TEXT("LiveKB"), TEXT("PeakKB"), TEXT("Spawned"), TEXT("Destroyed"), TEXT("Spawn/s"), TEXT("Destr/s"), TEXT("Overdue"));
+	for (int32 Index = 0; Index < (int32)EWarriorMemoryClass::Count; ++Index)
+	{
+		const FWarriorMemoryClassReport& Report = Reports[Index];
+		UE_LOG(LogWarrior, Log, TEXT("%-8s %7d %7d %10.1f %10.1f %9lld %9lld %9.2f %9.2f %8d"),
+			GetClassName((EWarriorMemoryClass)Index), Report.Live, Report.Peak, Report.LiveBytes / 1024.0, Report.PeakBytes / 1024.0,
+			Report.Spawned, Report.Destroyed, Report.SpawnedPerSecond, Report.DestroyedPerSecond, Report.Overdue);
+		if (Report.Overdue > 0)
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("%d %s actors outlived their InitialLifeSpan"), Report.Overdue, GetClassName((EWarriorMemoryClass)Index));
+		}
+	}
+}
+
+bool FWarriorMemoryTracker::StartCsv(const FString& Path, float Interval)
+{
+	StopCsv();
+
+	WarriorMemory::CsvPath = Path.IsEmpty()
+		? FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorMemory-%s.csv"), *FDateTime::Now().ToString())
+		: Path;
+	if (!FFileHelper::SaveStringToFile(FString(GetCsvHeader()) + LINE_TERMINATOR, *WarriorMemory::CsvPath))
+	{
+		UE_LOG(LogWarrior, Warning, TEXT("Could not write the memory report to %s"), *WarriorMemory::CsvPath);
+		return false;
+	}
+
+	WarriorMemory::CsvStartTime = FPlatformTime::Seconds();
+	WarriorMemory::CsvTickerHandle = FTicker::GetCoreTicker().AddTicker(FTickerDelegate::CreateStatic(&WarriorMemory::WriteCsvRows), FMath::Max(Interval, 0.1f));
+	UE_LOG(LogWarrior, Log, TEXT("Combat memory report every %.1fs to %s"), Interval, *WarriorMemory::CsvPath);
+	return true;
+}
+
+void FWarriorMemoryTracker::StopCsv()
+{
+	if (WarriorMemory::CsvTickerHandle.IsValid())
+	{
+		FTicker::GetCoreTicker().RemoveTicker(WarriorMemory::CsvTickerHandle);
+		WarriorMemory::CsvTickerHandle.Reset();
+	}
+}
+
+const TCHAR* FWarriorMemoryTracker::GetCsvHeader()
+{
+	return TEXT("Seconds,Class,Live,Peak,LiveKB,PeakKB,Spawned,Destroyed,SpawnedPerSec,DestroyedPerSec,Overdue");
+}
+
+const TCHAR* FWarriorMemoryTracker::GetClassName(EWarriorMemoryClass Class)
+{
+	switch (Class)
+	{
+	case EWarriorMemoryClass::Arrow:	return TEXT("Arrow");
+	case EWarriorMemoryClass::Box:		return TEXT("Box");
+	case EWarriorMemoryClass::Warrior:	return TEXT("Warrior");
+	default:							return TEXT("Unknown");
+	}
+}
+
+static FAutoConsoleCommand WarriorMemoryReportCommand(
+	TEXT("Warrior.Memory.Report"),
+	TEXT("Prints live counts, bytes, peaks and churn per second of arrows, boxes and warriors"),
+	FConsoleCommandDelegate::CreateStatic(&FWarriorMemoryTracker::LogReport));
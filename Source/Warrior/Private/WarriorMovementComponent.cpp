@@ -0,0 +1,17 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorMovementComponent.h"
+#include "WarriorCombatCharacter.h"
+
+float UWarriorMovementComponent::GetMaxSpeed() const
+{
+	const float MaxSpeed = Super::GetMaxSpeed();
+
+	const AWarriorCombatCharacter* Warrior = Cast<AWarriorCombatCharacter>(CharacterOwner);
+	if (Warrior && (MovementMode == MOVE_Walking || MovementMode == MOVE_NavWalking))
+	{
+		return MaxSpeed * (1.f - Warrior->GetSlowFactor());
+	}
+	return MaxSpeed;
+}
@@ -0,0 +1,364 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorNavigationService.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "NavigationData.h"
+#include "NavigationSystem.h"
+
+DECLARE_CYCLE_STAT(TEXT("Navigation Tick"), STAT_WarriorNavigationTick, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Requests"), STAT_WarriorPathRequests, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Queries Sent"), STAT_WarriorPathQueries, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Cache Hits"), STAT_WarriorPathCacheHits, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Path Requests Coalesced"), STAT_WarriorPathCoalesced, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Cached Paths"), STAT_WarriorCachedPaths, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Path Queries Queued"), STAT_WarriorPathQueued, STATGROUP_Warrior);
+
+AWarriorNavigationService::AWarriorNavigationService()
+{
+	// Chasers' movement input must be in before the character movement ticks
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	CellSize = 200.f;
+	MaxQueriesPerFrame = 8;
+	MaxQueriesInFlight = 32;
+	CacheLifetime = 2.f;
+	FailedPathLifetime = 0.5f;
+	MaxCachedPaths = 1024;
+	RepathInterval = 1.f;
+	RepathDistance = 300.f;
+	MaxChaseDistance = 5000.f;
+	MaxChaseFailures = 5;
+	AcceptanceRadius = 100.f;
+
+	NumInFlight = 0;
+	CacheGeneration = 0;
+	TimeToNextPurge = 0.f;
+}
+
+void AWarriorNavigationService::BeginPlay()
+{
+	Super::BeginPlay();
+
+	if (UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld()))
+	{
+		NavSys->OnNavigationGenerationFinishedDelegate.AddDynamic(this, &AWarriorNavigationService::OnNavigationGenerationFinished);
+	}
+}
+
+AWarriorNavigationService::FPathKey AWarriorNavigationService::MakeKey(const FVector& Start, const FVector& Goal) const
+{
+	const float InvCellSize = 1.f / FMath::Max(CellSize, 1.f);
+	FPathKey Key;
+	Key.Start = FIntVector(FMath::FloorToInt(Start.X * InvCellSize), FMath::FloorToInt(Start.Y * InvCellSize), FMath::FloorToInt(Start.Z * InvCellSize));
+	Key.Goal = FIntVector(FMath::FloorToInt(Goal.X * InvCellSize), FMath::FloorToInt(Goal.Y * InvCellSize), FMath::FloorToInt(Goal.Z * InvCellSize));
+	return Key;
+}
+
+bool AWarriorNavigationService::IsExpired(const FCachedPath& Cached, float Now) const
+{
+	return Now - Cached.Time >= (Cached.Points.Num() > 0 ? CacheLifetime : FailedPathLifetime);
+}
+
+void AWarriorNavigationService::RequestPath(const FVector& Start, const FVector& Goal, const FWarriorPathDelegate& Callback)
+{
+	INC_DWORD_STAT(STAT_WarriorPathRequests);
+
+	const FPathKey Key = MakeKey(Start, Goal);
+
+	if (const FCachedPath* Cached = Cache.Find(Key))
+	{
+		if (!IsExpired(*Cached, GetWorld()->GetTimeSeconds()))
+		{
+			INC_DWORD_STAT(STAT_WarriorPathCacheHits);
+			FReadyCallback& Entry = Ready.AddDefaulted_GetRef();
+			Entry.Callback = Callback;
+			Entry.Key = Key;
+			Entry.bFromCache = true;
+			return;
+		}
+		Cache.Remove(Key);
+	}
+
+	if (FPendingQuery* Query = Pending.Find(Key))
+	{
+		INC_DWORD_STAT(STAT_WarriorPathCoalesced);
+		Query->Callbacks.Add(Callback);
+		return;
+	}
+
+	FPendingQuery& Query = Pending.Add(Key);
+	Query.Start = Start;
+	Query.Goal = Goal;
+	Query.Callbacks.Add(Callback);
+	Queue.Add(Key);
+}
+
+void AWarriorNavigationService::ChaseTarget(AWarriorCombatCharacter* Warrior, AActor* Target)
+{
+	if (Warrior == nullptr || Target == nullptr)
+	{
+		return;
+	}
+
+	FChaser& Chaser = Chasers.FindOrAdd(Warrior);
+	if (Chaser.Target.Get() != Target)
+	{
+		Chaser.Warrior = Warrior;
+		Chaser.Target = Target;
+		Chaser.Points.Reset();
+		Chaser.PathIndex = 0;
+		Chaser.NumFailures = 0;
+		// Asks for a path on the next tick
+		Chaser.TimeSinceRequest = RepathInterval;
+	}
+}
+
+void AWarriorNavigationService::StopChasing(AWarriorCombatCharacter* Warrior)
+{
+	Chasers.Remove(Warrior);
+}
+
+void AWarriorNavigationService::InvalidateCache()
+{
+	Cache.Reset();
+	// Queries already sent were made on the old navmesh, their results are delivered but not cached
+	++CacheGeneration;
+}
+
+void AWarriorNavigationService::OnNavigationGenerationFinished(ANavigationData* NavData)
+{
+	UE_LOG(LogWarrior, Verbose, TEXT("Navmesh rebuilt, dropping %d cached paths"), Cache.Num());
+	InvalidateCache();
+}
+
+void AWarriorNavigationService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorNavigationTick);
+
+	Super::Tick(DeltaTime);
+
+	TimeToNextPurge -= DeltaTime;
+	if (TimeToNextPurge <= 0.f)
+	{
+		TimeToNextPurge = CacheLifetime;
+		PurgeCache();
+	}
+
+	// Chasers first so their requests are sent this frame
+	UpdateChasers(DeltaTime);
+	SendQueries();
+	DeliverCallbacks();
+
+	SET_DWORD_STAT(STAT_WarriorCachedPaths, Cache.Num());
+	SET_DWORD_STAT(STAT_WarriorPathQueued, Queue.Num());
+}
+
+void AWarriorNavigationService::SendQueries()
+{
+	UNavigationSystemV1* NavSys = FNavigationSystem::GetCurrent<UNavigationSystemV1>(GetWorld());
+	const ANavigationData* NavData = NavSys ? NavSys->GetDefaultNavDataInstance(FNavigationSystem::DontCreate) : nullptr;
+
+	int32 QueriesLeft = MaxQueriesPerFrame;
+	int32 NumSent = 0;
+	for (; NumSent < Queue.Num() && QueriesLeft > 0 && NumInFlight < MaxQueriesInFlight; ++NumSent)
+	{
+		const FPathKey Key = Queue[NumSent];
+		FPendingQuery& Query = Pending[Key];
+
+		if (NavData == nullptr)
+		{
+			// No navmesh: head straight for the goal, without caching since a navmesh may come later
+			for (FWarriorPathDelegate& Callback : Query.Callbacks)
+			{
+				FReadyCallback& Entry = Ready.AddDefaulted_GetRef();
+				Entry.Callback = MoveTemp(Callback);
+				Entry.Points.Add(Query.Goal);
+				Entry.bFromCache = false;
+			}
+			Pending.Remove(Key);
+			continue;
+		}
+
+		INC_DWORD_STAT(STAT_WarriorPathQueries);
+		--QueriesLeft;
+		++NumInFlight;
+		Query.bSent = true;
+		Query.Generation = CacheGeneration;
+
+		FPathFindingQuery PathQuery(this, *NavData, Query.Start, Query.Goal, NavData->GetDefaultQueryFilter());
+		NavSys->FindPathAsync(FNavAgentProperties::DefaultProperties, PathQuery,
+			FNavPathQueryDelegate::CreateUObject(this, &AWarriorNavigationService::OnPathFound, Key), EPathFindingMode::Regular);
+	}
+	Queue.RemoveAt(0, NumSent, false);
+}
+
+void AWarriorNavigationService::OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, FPathKey Key)
+{
+	NumInFlight = FMath::Max(NumInFlight - 1, 0);
+
+	FPendingQuery Query;
+	if (!Pending.RemoveAndCopyValue(Key, Query))
+	{
+		return;
+	}
+
+	TArray<FVector> Points;
+	if (Result == ENavigationQueryResult::Success && Path.IsValid())
+	{
+		const TArray<FNavPathPoint>& PathPoints = Path->GetPathPoints();
+		Points.Reserve(PathPoints.Num());
+		for (const FNavPathPoint& Point : PathPoints)
+		{
+			Points.Add(Point.Location);
+		}
+	}
+
+	// Failures are cached too, for a shorter time; aborted queries are not failures of the path
+	const bool bCache = Query.Generation == CacheGeneration && (Points.Num() > 0 || Result == ENavigationQueryResult::Fail);
+	if (bCache)
+	{
+		FCachedPath& Cached = Cache.Add(Key);
+		Cached.Points = Points;
+		Cached.Time = GetWorld()->GetTimeSeconds();
+	}
+
+	for (FWarriorPathDelegate& Callback : Query.Callbacks)
+	{
+		FReadyCallback& Entry = Ready.AddDefaulted_GetRef();
+		Entry.Callback = MoveTemp(Callback);
+		Entry.Key = Key;
+		if (bCache)
+		{
+			Entry.bFromCache = true;
+		}
+		else
+		{
+			Entry.Points = Points;
+			Entry.bFromCache = false;
+		}
+	}
+}
+
+void AWarriorNavigationService::DeliverCallbacks()
+{
+	static const TArray<FVector> NoPath;
+
+	// Callbacks may request new paths, those are delivered next frame
+	TArray<FReadyCallback> Delivering = MoveTemp(Ready);
+	Ready.Reset();
+
+	for (const FReadyCallback& Entry : Delivering)
+	{
+		if (Entry.bFromCache)
+		{
+			// The cache may have been invalidated since, an empty path makes the requester ask again
+			const FCachedPath* Cached = Cache.Find(Entry.Key);
+			Entry.Callback.ExecuteIfBound(Cached ? Cached->Points : NoPath);
+		}
+		else
+		{
+			Entry.Callback.ExecuteIfBound(Entry.Points);
+		}
+	}
+}
+
+void AWarriorNavigationService::PurgeCache()
+{
+	const float Now = GetWorld()->GetTimeSeconds();
+	for (auto It = Cache.CreateIterator(); It; ++It)
+	{
+		if (IsExpired(It.Value(), Now))
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	// Still too many: drop the oldest
+	if (Cache.Num() > MaxCachedPaths)
+	{
+		Cache.ValueSort([](const FCachedPath& A, const FCachedPath& B) { return A.Time > B.Time; });
+		int32 Index = 0;
+		for (auto It = Cache.CreateIterator(); It; ++It, ++Index)
+		{
+			if (Index >= MaxCachedPaths)
+			{
+				It.RemoveCurrent();
+			}
+		}
+	}
+}
+
+void AWarriorNavigationService::UpdateChasers(float DeltaTime)
+{
+	for (auto It = Chasers.CreateIterator(); It; ++It)
+	{
+		FChaser& Chaser = It.Value();
+		AWarriorCombatCharacter* Warrior = Chaser.Warrior.Get();
+		const AWarriorCombatCharacter* TargetWarrior = Cast<AWarriorCombatCharacter>(Chaser.Target.Get());
+		AActor* Target = Chaser.Target.Get();
+		if (Warrior == nullptr || Target == nullptr || Warrior->Health <= 0.f || (TargetWarrior && TargetWarrior->Health <= 0.f)
+			|| FVector::DistSquared(Warrior->GetActorLocation(), Target->GetActorLocation()) > FMath::Square(MaxChaseDistance))
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		if (Warrior->IsStreamingSuspended() || Warrior->IsPlayerControlled())
+		{
+			continue;
+		}
+
+		const FVector Location = Warrior->GetActorLocation();
+		const FVector Goal = Target->GetActorLocation();
+
+		Chaser.TimeSinceRequest += DeltaTime;
+		// After a failure, only the interval or the target moving brings a new request
+		const bool bNeedsPath = (Chaser.Points.Num() == 0 && Chaser.NumFailures == 0)
+			|| Chaser.TimeSinceRequest >= RepathInterval
+			|| FVector::DistSquared(Goal, Chaser.RequestedGoal) > FMath::Square(RepathDistance);
+		if (bNeedsPath && !Chaser.bRequestPending)
+		{
+			Chaser.bRequestPending = true;
+			Chaser.TimeSinceRequest = 0.f;
+			Chaser.RequestedGoal = Goal;
+			RequestPath(Location, Goal, FWarriorPathDelegate::CreateUObject(this, &AWarriorNavigationService::OnChasePath, Chaser.Warrior));
+		}
+
+		// Keeps following the previous path while the new one is on its way
+		while (Chaser.PathIndex < Chaser.Points.Num() && FVector::DistSquared2D(Chaser.Points[Chaser.PathIndex], Location) < FMath::Square(AcceptanceRadius))
+		{
+			++Chaser.PathIndex;
+		}
+		if (Chaser.PathIndex < Chaser.Points.Num())
+		{
+			Warrior->AddMovementInput((Chaser.Points[Chaser.PathIndex] - Location).GetSafeNormal2D());
+		}
+	}
+}
+
+void AWarriorNavigationService::OnChasePath(const TArray<FVector>& Points, TWeakObjectPtr<AWarriorCombatCharacter> Warrior)
+{
+	FChaser* Chaser = Chasers.Find(Warrior.Get());
+	if (Chaser == nullptr)
+	{
+		return;
+	}
+
+	Chaser->bRequestPending = false;
+	if (Points.Num() == 0)
+	{
+		// An unreachable target would cost a query every RepathInterval for as long as it is chased
+		if (++Chaser->NumFailures >= MaxChaseFailures)
+		{
+			UE_LOG(LogWarrior, Verbose, TEXT("%s found no path %d times in a row, stops chasing"), *GetNameSafe(Warrior.Get()), Chaser->NumFailures);
+			StopChasing(Warrior.Get());
+		}
+		return;
+	}
+
+	Chaser->NumFailures = 0;
+	Chaser->Points = Points;
+	Chaser->PathIndex = 0;
+}
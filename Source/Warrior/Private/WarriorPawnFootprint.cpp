@@ -0,0 +1,138 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "Warrior.h"
+#include "WarriorCharacter.h"
+#include "WarriorCombatCharacter.h"
+#include "Components/SceneComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+
+/**
+ * Warrior.MeasurePawns [Count] [Frames] [AIClass] [PlayerClass]
+ * Spawns Count warriors of each class and reports their per-instance cost: components, memory,
+ * spawn time and the time to move them (which updates the transform of every attached component).
+ * Classes default to the native ones, pass Blueprint class paths to include the meshes.
+ */
+namespace WarriorPawnFootprint
+{
+	struct FResult
+	{
+		int32 NumComponents = 0;
+		int32 NumSceneComponents = 0;
+		int32 NumTickingComponents = 0;
+		int64 ObjectBytes = 0;
+		int64 ResourceBytes = 0;
+		double SpawnMs = 0.0;
+		double TransformUs = 0.0;
+	};
+
+	static FResult Measure(UWorld* World, UClass* Class, int32 Count, int32 Frames)
+	{
+		FResult Result;
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		SpawnParams.ObjectFlags |= RF_Transient;
+
+		// Far above the battlefield so nothing overlaps the warriors already there
+		const FVector Origin(0.f, 0.f, 100000.f);
+
+		TArray<AActor*> Actors;
+		Actors.Reserve(Count);
+
+		const double SpawnStart = FPlatformTime::Seconds();
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			const FVector Location = Origin + FVector((Index % 32) * 200.f, (Index / 32) * 200.f, 0.f);
+			if (AActor* Actor = World->SpawnActor<AActor>(Class, Location, FRotator::ZeroRotator, SpawnParams))
+			{
+				Actors.Add(Actor);
+			}
+		}
+		Result.SpawnMs = (FPlatformTime::Seconds() - SpawnStart) * 1000.0;
+
+		if (Actors.Num() == 0)
+		{
+			return Result;
+		}
+
+		// All instances are alike, the first one is enough for the memory
+		AActor* First = Actors[0];
+		Result.ObjectBytes = First->GetClass()->GetStructureSize();
+		Result.ResourceBytes = First->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+
+		TInlineComponentArray<UActorComponent*> Components(First);
+		Result.NumComponents = Components.Num();
+		for (UActorComponent* Component : Components)
+		{
+			Result.ObjectBytes += Component->GetClass()->GetStructureSize();
+			Result.ResourceBytes += Component->GetResourceSizeBytes(EResourceSizeMode::Exclusive);
+			if (Component->IsA<USceneComponent>())
+			{
+				++Result.NumSceneComponents;
+			}
+			if (Component->PrimaryComponentTick.bCanEverTick && Component->IsComponentTickEnabled())
+			{
+				++Result.NumTickingComponents;
+			}
+		}
+
+		const double MoveStart = FPlatformTime::Seconds();
+		for (int32 Frame = 0; Frame < Frames; ++Frame)
+		{
+			const FVector Step(0.f, 0.f, (Frame & 1) ? -1.f : 1.f);
+			for (AActor* Actor : Actors)
+			{
+				Actor->SetActorLocation(Actor->GetActorLocation() + Step);
+			}
+		}
+		Result.TransformUs = (FPlatformTime::Seconds() - MoveStart) * 1000000.0 / (Frames * Actors.Num());
+
+		for (AActor* Actor : Actors)
+		{
+			Actor->Destroy();
+		}
+
+		Result.SpawnMs /= Actors.Num();
+		return Result;
+	}
+
+	static void Print(const TCHAR* Label, UClass* Class, const FResult& Result)
+	{
+		UE_LOG(LogWarrior, Log, TEXT("%-8s %-40s %10d %6d %7d %10.1f %10.1f %9.3f %9.3f"), Label, *Class->GetName(),
+			Result.NumComponents, Result.NumSceneComponents, Result.NumTickingComponents,
+			Result.ObjectBytes / 1024.0, Result.ResourceBytes / 1024.0, Result.SpawnMs, Result.TransformUs);
+	}
+
+	static void Run(const TArray<FString>& Args, UWorld* World)
+	{
+		if (World == nullptr)
+		{
+			return;
+		}
+
+		const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 100;
+		const int32 Frames = Args.Num() > 1 ? FMath::Max(FCString::Atoi(*Args[1]), 1) : 60;
+		UClass* AIClass = Args.Num() > 2 ? LoadClass<AWarriorCombatCharacter>(nullptr, *Args[2]) : AWarriorCombatCharacter::StaticClass();
+		UClass* PlayerClass = Args.Num() > 3 ? LoadClass<AWarriorCombatCharacter>(nullptr, *Args[3]) : AWarriorCharacter::StaticClass();
+		if (AIClass == nullptr || PlayerClass == nullptr)
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("MeasurePawns: could not load the warrior classes"));
+			return;
+		}
+
+		const FResult AIResult = Measure(World, AIClass, Count, Frames);
+		const FResult PlayerResult = Measure(World, PlayerClass, Count, Frames);
+
+		UE_LOG(LogWarrior, Log, TEXT("MeasurePawns: %d warriors per class, %d moves each"), Count, Frames);
+		UE_LOG(LogWarrior, Log, TEXT("%-8s %-40s %10s %6s %7s %10s %10s %9s %9s"), TEXT("Variant"), TEXT("Class"),
+			TEXT("Components"), TEXT("Scene"), TEXT("Ticking"), TEXT("ObjectKB"), TEXT("ResourceKB"), TEXT("SpawnMs"), TEXT("MoveUs"));
+		Print(TEXT("AI"), AIClass, AIResult);
+		Print(TEXT("Player"), PlayerClass, PlayerResult);
+	}
+}
+
+static FAutoConsoleCommandWithWorldAndArgs WarriorMeasurePawnsCommand(
+	TEXT("Warrior.MeasurePawns"),
+	TEXT("Compares the AI and player warrior per instance: components, memory, spawn time and transform update time. Args: [Count] [Frames] [AIClass] [PlayerClass]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateStatic(&WarriorPawnFootprint::Run));
@@ -0,0 +1,229 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorPawnPool.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "GameFramework/Controller.h"
+#include "HAL/IConsoleManager.h"
+
+DECLARE_CYCLE_STAT(TEXT("Pool Acquire"), STAT_WarriorPoolAcquire, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pool Reused"), STAT_WarriorPoolReused, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Pool Spawned"), STAT_WarriorPoolSpawned, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Pooled Warriors"), STAT_WarriorPooled, STATGROUP_Warrior);
+
+AWarriorPawnPool::AWarriorPawnPool()
+{
+	// Everything happens on death and respawn
+	PrimaryActorTick.bCanEverTick = false;
+
+	bEnabled = true;
+	MaxPooledPerClass = 256;
+	PrewarmLocation = FVector(0.f, 0.f, -100000.f);
+}
+
+bool AWarriorPawnPool::Release(AWarriorCombatCharacter* Warrior)
+{
+	if (!bEnabled || Warrior == nullptr || Warrior->IsPendingKill() || Warrior->IsPooled() || Warrior->Role < ROLE_Authority)
+	{
+		return false;
+	}
+
+	const TArray<FPooledWarrior>* Pool = Pools[Warrior->Team ? 1 : 0].Find(Warrior->GetClass());
+	if (Pool && Pool->Num() >= MaxPooledPerClass)
+	{
+		return false;
+	}
+
+	Warrior->SetPooled(true);
+	Park(Warrior);
+	return true;
+}
+
+void AWarriorPawnPool::Park(AWarriorCombatCharacter* Warrior)
+{
+	FPooledWarrior& Entry = Pools[Warrior->Team ? 1 : 0].FindOrAdd(Warrior->GetClass()).AddDefaulted_GetRef();
+	Entry.Warrior = Warrior;
+	if (AController* Controller = Warrior->GetController())
+	{
+		// Players keep their controller and get a pawn back through the game mode
+		if (!Controller->IsPlayerController())
+		{
+			Entry.Controller = Controller;
+		}
+		Controller->UnPossess();
+	}
+	INC_DWORD_STAT(STAT_WarriorPooled);
+}
+
+AWarriorCombatCharacter* AWarriorPawnPool::Acquire(TSubclassOf<AWarriorCombatCharacter> Class, bool Team, const FTransform& Transform, AController* Controller, bool bSpawnAIController)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorPoolAcquire);
+
+	if (Class == nullptr)
+	{
+		return nullptr;
+	}
+
+	AWarriorCombatCharacter* Warrior = nullptr;
+	AController* PooledController = nullptr;
+	if (TArray<FPooledWarrior>* Pool = Pools[Team ? 1 : 0].Find(Class))
+	{
+		// Entries of warriors destroyed since (level unload, match end) are skipped
+		while (Warrior == nullptr && Pool->Num() > 0)
+		{
+			const FPooledWarrior Entry = Pool->Pop(false);
+			DEC_DWORD_STAT(STAT_WarriorPooled);
+			Warrior = Entry.Warrior.Get();
+			PooledController = Entry.Controller.Get();
+		}
+	}
+
+	if (Warrior)
+	{
+		Warrior->SetActorLocationAndRotation(Transform.GetLocation(), Transform.GetRotation(), false, nullptr, ETeleportType::TeleportPhysics);
+		Warrior->ResetForRespawn();
+		Warrior->SetPooled(false);
+		INC_DWORD_STAT(STAT_WarriorPoolReused);
+	}
+	else
+	{
+		// The team is set before BeginPlay and PostInitializeComponents, which depend on it
+		Warrior = GetWorld()->SpawnActorDeferred<AWarriorCombatCharacter>(Class, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn);
+		if (Warrior == nullptr)
+		{
+			return nullptr;
+		}
+		Warrior->Team = Team;
+		Warrior->FinishSpawning(Transform);
+		INC_DWORD_STAT(STAT_WarriorPoolSpawned);
+	}
+
+	if (PooledController && !PooledController->IsPendingKill() && (Controller || !bSpawnAIController))
+	{
+		// The warrior goes to another controller, its old AI controller would be left without a pawn
+		PooledController->Destroy();
+		PooledController = nullptr;
+	}
+
+	if (Controller)
+	{
+		Controller->Possess(Warrior);
+	}
+	else if (PooledController && !PooledController->IsPendingKill())
+	{
+		PooledController->Possess(Warrior);
+	}
+	else if (bSpawnAIController && Warrior->GetController() == nullptr)
+	{
+		Warrior->SpawnDefaultController();
+	}
+
+	return Warrior;
+}
+
+void AWarriorPawnPool::SpawnWave(TSubclassOf<AWarriorCombatCharacter> Class, bool Team, const TArray<FTransform>& Transforms, TArray<AWarriorCombatCharacter*>& OutWarriors)
+{
+	OutWarriors.Reserve(OutWarriors.Num() + Transforms.Num());
+	for (const FTransform& Transform : Transforms)
+	{
+		if (AWarriorCombatCharacter* Warrior = Acquire(Class, Team, Transform))
+		{
+			OutWarriors.Add(Warrior);
+		}
+	}
+}
+
+void AWarriorPawnPool::Prewarm(TSubclassOf<AWarriorCombatCharacter> Class, bool Team, int32 Count)
+{
+	if (Class == nullptr || Role < ROLE_Authority)
+	{
+		return;
+	}
+
+	const int32 NumToBuild = FMath::Min(Count, MaxPooledPerClass) - GetNumPooled(Class, Team);
+	for (int32 Index = 0; Index < NumToBuild; ++Index)
+	{
+		const FTransform Transform(PrewarmLocation + FVector((Index % 32) * 200.f, (Index / 32) * 200.f, 0.f));
+
+		// Flagged before BeginPlay so it spawns no box and joins no service
+		AWarriorCombatCharacter* Warrior = GetWorld()->SpawnActorDeferred<AWarriorCombatCharacter>(Class, Transform, nullptr, nullptr, ESpawnActorCollisionHandlingMethod::AlwaysSpawn);
+		if (Warrior == nullptr)
+		{
+			break;
+		}
+		Warrior->Team = Team;
+		Warrior->SetPooled(true);
+		Warrior->FinishSpawning(Transform);
+		Park(Warrior);
+	}
+}
+
+int32 AWarriorPawnPool::GetNumPooled(TSubclassOf<AWarriorCombatCharacter> Class, bool Team) const
+{
+	const TArray<FPooledWarrior>* Pool = Pools[Team ? 1 : 0].Find(Class);
+	return Pool ? Pool->Num() : 0;
+}
+
+/**
+ * Warrior.Pool.TestWave [Count] [Class]
+ * Times a respawn wave of Count warriors built from scratch against the same wave out of the pool.
+ */
+static FAutoConsoleCommandWithWorldAndArgs WarriorPoolTestWaveCommand(
+	TEXT("Warrior.Pool.TestWave"),
+	TEXT("Compares a respawn wave of new warriors with one from the pool. Args: [Count] [Class]"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		AWarriorPawnPool* Pool = World ? AWarriorWorldService::Get<AWarriorPawnPool>(World) : nullptr;
+		if (Pool == nullptr)
+		{
+			return;
+		}
+
+		const int32 Count = Args.Num() > 0 ? FMath::Max(FCString::Atoi(*Args[0]), 1) : 50;
+		UClass* Class = Args.Num() > 1 ? LoadClass<AWarriorCombatCharacter>(nullptr, *Args[1]) : AWarriorCombatCharacter::StaticClass();
+		if (Class == nullptr)
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("Pool.TestWave: could not load the warrior class"));
+			return;
+		}
+
+		// On the team the class spawns with, next to the prewarmed ones, away from the battle
+		const bool Team = Class->GetDefaultObject<AWarriorCombatCharacter>()->Team;
+		TArray<FTransform> Transforms;
+		for (int32 Index = 0; Index < Count; ++Index)
+		{
+			Transforms.Add(FTransform(Pool->PrewarmLocation + FVector((Index % 32) * 200.f, (Index / 32) * 200.f, 2000.f)));
+		}
+
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		TArray<AWarriorCombatCharacter*> Warriors;
+		const double SpawnStart = FPlatformTime::Seconds();
+		for (const FTransform& Transform : Transforms)
+		{
+			if (AWarriorCombatCharacter* Warrior = World->SpawnActor<AWarriorCombatCharacter>(Class, Transform, SpawnParams))
+			{
+				Warrior->SpawnDefaultController();
+				Warriors.Add(Warrior);
+			}
+		}
+		const double SpawnMs = (FPlatformTime::Seconds() - SpawnStart) * 1000.0;
+		for (AWarriorCombatCharacter* Warrior : Warriors)
+		{
+			Warrior->Destroy();
+		}
+		Warriors.Reset();
+
+		Pool->Prewarm(Class, Team, Count);
+		const double PoolStart = FPlatformTime::Seconds();
+		Pool->SpawnWave(Class, Team, Transforms, Warriors);
+		const double PoolMs = (FPlatformTime::Seconds() - PoolStart) * 1000.0;
+		for (AWarriorCombatCharacter* Warrior : Warriors)
+		{
+			Pool->Release(Warrior);
+		}
+
+		UE_LOG(LogWarrior, Log, TEXT("Pool.TestWave: %d x %s, new %.2f ms, pooled %.2f ms (%.1fx)"),
+			Count, *Class->GetName(), SpawnMs, PoolMs, PoolMs > 0.0 ? SpawnMs / PoolMs : 0.0);
+	}));
@@ -0,0 +1,28 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorProcessUtils.h"
+#include "Warrior.h"
+
+namespace WarriorProcessUtils
+{
+	FProcHandle Launch(const FString& Params)
+	{
+		const FString Executable = FPlatformProcess::ExecutablePath();
+		UE_LOG(LogWarrior, Log, TEXT("Launching %s %s"), *Executable, *Params);
+		return FPlatformProcess::CreateProc(*Executable, *Params, false, true, true, nullptr, 0, nullptr, nullptr);
+	}
+
+	void Terminate(TArray<FProcHandle>& Processes)
+	{
+		for (FProcHandle& Process : Processes)
+		{
+			if (Process.IsValid())
+			{
+				FPlatformProcess::TerminateProc(Process, true);
+				FPlatformProcess::CloseProc(Process);
+			}
+		}
+		Processes.Reset();
+	}
+}
@@ -0,0 +1,306 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorReplicationGraph.h"
+#include "Warrior.h"
+#include "Arrow.h"
+#include "BoxActor.h"
+#include "WarriorCombatCharacter.h"
+#include "WarriorComboState.h"
+#include "Engine/ChildConnection.h"
+#include "Engine/LevelScriptActor.h"
+#include "Engine/NetConnection.h"
+#include "GameFramework/Info.h"
+#include "GameFramework/PlayerController.h"
+#include "GameFramework/PlayerState.h"
+#include "UObject/UObjectIterator.h"
+
+UWarriorReplicationGraph::UWarriorReplicationGraph()
+{
+	// A few arrow flights wide
+	CellSize = 10000.f;
+	SpatialBias = FVector2D(-200000.f, -200000.f);
+
+	WarriorCullDistance = 15000.f;
+	BoxCullDistance = 10000.f;
+	ArrowCullDistance = 10000.f;
+
+	WarriorNetUpdateFrequency = 30.f;
+	ArrowNetUpdateFrequency = 30.f;
+	// Boxes never move, they only need to show up and go away
+	BoxNetUpdateFrequency = 2.f;
+	ComboStateNetUpdateFrequency = 10.f;
+	PlayerStateNetUpdateFrequency = 2.f;
+
+	GridNode = nullptr;
+	AlwaysRelevantNode = nullptr;
+}
+
+void UWarriorReplicationGraph::ResetGameWorldState()
+{
+	Super::ResetGameWorldState();
+
+	for (FActorRepListRefView& List : TeamActors)
+	{
+		List.Reset();
+	}
+}
+
+void UWarriorReplicationGraph::InitGlobalActorClassSettings()
+{
+	Super::InitGlobalActorClassSettings();
+
+	ClassRepNodePolicies.Set(AReplicationGraphDebugActor::StaticClass(), EWarriorClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(ALevelScriptActor::StaticClass(), EWarriorClassRepNodeMapping::NotRouted);
+	ClassRepNodePolicies.Set(APlayerState::StaticClass(), EWarriorClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(AInfo::StaticClass(), EWarriorClassRepNodeMapping::RelevantAllConnections);
+	ClassRepNodePolicies.Set(AWarriorComboState::StaticClass(), EWarriorClassRepNodeMapping::TeamOnly);
+	ClassRepNodePolicies.Set(AWarriorCombatCharacter::StaticClass(), EWarriorClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(AArrow::StaticClass(), EWarriorClassRepNodeMapping::Spatialize_Dynamic);
+	ClassRepNodePolicies.Set(ABoxActor::StaticClass(), EWarriorClassRepNodeMapping::Spatialize_Dormancy);
+
+	// Every other replicated class is routed from its defaults
+	TArray<UClass*> ReplicatedClasses;
+	for (TObjectIterator<UClass> It; It; ++It)
+	{
+		UClass* Class = *It;
+		const AActor* ActorCDO = Cast<AActor>(Class->GetDefaultObject());
+		if (ActorCDO == nullptr || !ActorCDO->GetIsReplicated())
+		{
+			continue;
+		}
+
+		// Blueprint compilation leftovers
+		if (Class->GetName().StartsWith(TEXT("SKEL_")) || Class->GetName().StartsWith(TEXT("REINST_")))
+		{
+			continue;
+		}
+
+		ReplicatedClasses.Add(Class);
+		if (ClassRepNodePolicies.Contains(Class, false))
+		{
+			continue;
+		}
+
+		const bool bSpatialize = !(ActorCDO->bAlwaysRelevant || ActorCDO->bOnlyRelevantToOwner || ActorCDO->bNetUseOwnerRelevancy);
+		if (bSpatialize)
+		{
+			ClassRepNodePolicies.Set(Class, ActorCDO->bReplicateMovement ? EWarriorClassRepNodeMapping::Spatialize_Dynamic : EWarriorClassRepNodeMapping::Spatialize_Dormancy);
+		}
+		else if (ActorCDO->bAlwaysRelevant && !ActorCDO->bOnlyRelevantToOwner)
+		{
+			ClassRepNodePolicies.Set(Class, EWarriorClassRepNodeMapping::RelevantAllConnections);
+		}
+		else
+		{
+			ClassRepNodePolicies.Set(Class, EWarriorClassRepNodeMapping::NotRouted);
+		}
+	}
+
+	// Per class rates, culling and priorities
+	TArray<UClass*> ExplicitClasses;
+	auto SetClassInfo = [&](UClass* Class, bool bSpatialize, float Frequency, float CullDistance)
+	{
+		FClassReplicationInfo Info;
+		InitClassReplicationInfo(Info, Class, bSpatialize, Frequency);
+		if (bSpatialize)
+		{
+			Info.CullDistanceSquared = FMath::Square(CullDistance);
+		}
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, Info);
+		ExplicitClasses.Add(Class);
+	};
+	SetClassInfo(AWarriorCombatCharacter::StaticClass(), true, WarriorNetUpdateFrequency, WarriorCullDistance);
+	SetClassInfo(AArrow::StaticClass(), true, ArrowNetUpdateFrequency, ArrowCullDistance);
+	SetClassInfo(ABoxActor::StaticClass(), true, BoxNetUpdateFrequency, BoxCullDistance);
+	SetClassInfo(AWarriorComboState::StaticClass(), false, ComboStateNetUpdateFrequency, 0.f);
+	SetClassInfo(APlayerState::StaticClass(), false, PlayerStateNetUpdateFrequency, 0.f);
+
+	for (UClass* Class : ReplicatedClasses)
+	{
+		if (ExplicitClasses.ContainsByPredicate([Class](const UClass* Explicit) { return Class->IsChildOf(Explicit); }))
+		{
+			continue;
+		}
+
+		const EWarriorClassRepNodeMapping Policy = ClassRepNodePolicies.GetChecked(Class);
+		const bool bSpatialize = Policy == EWarriorClassRepNodeMapping::Spatialize_Static
+			|| Policy == EWarriorClassRepNodeMapping::Spatialize_Dynamic
+			|| Policy == EWarriorClassRepNodeMapping::Spatialize_Dormancy;
+
+		FClassReplicationInfo Info;
+		InitClassReplicationInfo(Info, Class, bSpatialize, Class->GetDefaultObject<AActor>()->NetUpdateFrequency);
+		GlobalActorReplicationInfoMap.SetClassInfo(Class, Info);
+	}
+}
+
+void UWarriorReplicationGraph::InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize, float NetUpdateFrequency) const
+{
+	const AActor* ActorCDO = Class->GetDefaultObject<AActor>();
+	if (bSpatialize)
+	{
+		Info.CullDistanceSquared = ActorCDO->NetCullDistanceSquared;
+	}
+
+	const float ServerTickRate = NetDriver->NetServerMaxTickRate;
+	Info.ReplicationPeriodFrame = FMath::Max<uint32>((uint32)FMath::RoundToFloat(ServerTickRate / FMath::Max(NetUpdateFrequency, 0.1f)), 1);
+}
+
+void UWarriorReplicationGraph::InitGlobalGraphNodes()
+{
+	PreAllocateRepList(3, 12);
+	PreAllocateRepList(6, 12);
+	PreAllocateRepList(128, 64);
+	PreAllocateRepList(512, 16);
+
+	GridNode = CreateNewNode<UReplicationGraphNode_GridSpatialization2D>();
+	GridNode->CellSize = CellSize;
+	GridNode->SpatialBias = SpatialBias;
+	AddGlobalGraphNode(GridNode);
+
+	AlwaysRelevantNode = CreateNewNode<UReplicationGraphNode_ActorList>();
+	AddGlobalGraphNode(AlwaysRelevantNode);
+
+	for (FActorRepListRefView& List : TeamActors)
+	{
+		List.Reset();
+	}
+}
+
+void UWarriorReplicationGraph::InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection)
+{
+	Super::InitConnectionGraphNodes(RepGraphConnection);
+
+	AddConnectionGraphNode(CreateNewNode<UWarriorReplicationGraphNode_ForConnection>(), RepGraphConnection);
+}
+
+EWarriorClassRepNodeMapping UWarriorReplicationGraph::GetMappingPolicy(UClass* Class)
+{
+	const EWarriorClassRepNodeMapping* Policy = ClassRepNodePolicies.Get(Class);
+	return Policy ? *Policy : EWarriorClassRepNodeMapping::NotRouted;
+}
+
+int32 UWarriorReplicationGraph::GetActorTeam(const AActor* Actor)
+{
+	// Team only actors are owned by their warrior, whose team is known at spawn
+	const AWarriorCombatCharacter* Warrior = Cast<AWarriorCombatCharacter>(Actor ? Actor->GetOwner() : nullptr);
+	return Warrior ? (Warrior->Team ? 1 : 0) : INDEX_NONE;
+}
+
+void UWarriorReplicationGraph::RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EWarriorClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyAddNetworkActor(ActorInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::Spatialize_Static:
+		GridNode->AddActor_Static(ActorInfo, GlobalInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->AddActor_Dynamic(ActorInfo, GlobalInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->AddActor_Dormancy(ActorInfo, GlobalInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::TeamOnly:
+	{
+		const int32 Team = GetActorTeam(ActorInfo.Actor);
+		if (Team != INDEX_NONE)
+		{
+			TeamActors[Team].Add(ActorInfo.Actor);
+		}
+		else
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("ReplicationGraph: %s has no team, it won't be replicated"), *GetNameSafe(ActorInfo.Actor));
+		}
+		break;
+	}
+
+	default:
+		break;
+	}
+}
+
+void UWarriorReplicationGraph::RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo)
+{
+	switch (GetMappingPolicy(ActorInfo.Class))
+	{
+	case EWarriorClassRepNodeMapping::RelevantAllConnections:
+		AlwaysRelevantNode->NotifyRemoveNetworkActor(ActorInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::Spatialize_Static:
+		GridNode->RemoveActor_Static(ActorInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::Spatialize_Dynamic:
+		GridNode->RemoveActor_Dynamic(ActorInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::Spatialize_Dormancy:
+		GridNode->RemoveActor_Dormancy(ActorInfo);
+		break;
+
+	case EWarriorClassRepNodeMapping::TeamOnly:
+		// The owner may already be gone
+		for (FActorRepListRefView& List : TeamActors)
+		{
+			List.Remove(ActorInfo.Actor);
+		}
+		break;
+
+	default:
+		break;
+	}
+}
+
+void UWarriorReplicationGraphNode_ForConnection::GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params)
+{
+	ReplicationActorList.Reset();
+
+	// Split screen players (bot clients) are child connections of the same connection
+	bool bTeams[2] = { false, false };
+	auto AddViewer = [this, &bTeams](UNetConnection* Connection)
+	{
+		APlayerController* Controller = Connection ? Connection->PlayerController : nullptr;
+		if (Controller == nullptr)
+		{
+			return;
+		}
+
+		ReplicationActorList.ConditionalAdd(Controller);
+		ReplicationActorList.ConditionalAdd(Connection->ViewTarget);
+		APawn* Pawn = Controller->GetPawn();
+		if (Pawn && Pawn != Connection->ViewTarget)
+		{
+			ReplicationActorList.ConditionalAdd(Pawn);
+		}
+		if (const AWarriorCombatCharacter* Warrior = Cast<AWarriorCombatCharacter>(Pawn))
+		{
+			bTeams[Warrior->Team ? 1 : 0] = true;
+		}
+	};
+
+	UNetConnection* NetConnection = Params.ConnectionManager.NetConnection;
+	AddViewer(NetConnection);
+	for (UChildConnection* Child : NetConnection->Children)
+	{
+		AddViewer(Child);
+	}
+
+	Params.OutGatheredReplicationLists.AddReplicationActorList(ReplicationActorList);
+
+	const UWarriorReplicationGraph* Graph = CastChecked<UWarriorReplicationGraph>(GetOuter());
+	for (int32 Team = 0; Team < 2; ++Team)
+	{
+		if (bTeams[Team] && Graph->GetTeamActors(Team).Num() > 0)
+		{
+			Params.OutGatheredReplicationLists.AddReplicationActorList(Graph->GetTeamActors(Team));
+		}
+	}
+}
@@ -0,0 +1,357 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorSquadService.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "WarriorNavigationService.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Squad Tick"), STAT_WarriorSquadTick, STATGROUP_Warrior);
+DECLARE_CYCLE_STAT(TEXT("Squad Flocking"), STAT_WarriorSquadFlocking, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Squad Path Requests"), STAT_WarriorSquadPathRequests, STATGROUP_Warrior);
+
+namespace WarriorSquad
+{
+	/** Padding lanes are parked far away so they never pass the neighbor test */
+	static const float FarAway = 1.e9f;
+
+	/** Sums the 4 lanes of a register */
+	static float HorizontalAdd(const VectorRegister& Vector)
+	{
+		MS_ALIGN(16) float Lanes[4] GCC_ALIGN(16);
+		VectorStoreAligned(Vector, Lanes);
+		return Lanes[0] + Lanes[1] + Lanes[2] + Lanes[3];
+	}
+}
+
+AWarriorSquadService::AWarriorSquadService()
+{
+	// Movement input must be in before the character movement ticks
+	PrimaryActorTick.TickGroup = TG_PrePhysics;
+
+	MaxSquadSize = 20;
+	JoinRadius = 1500.f;
+	FormationSpacing = 150.f;
+	NeighborRadius = 120.f;
+	SlotWeight = 1.f;
+	SeparationWeight = 1.5f;
+	CohesionWeight = 0.2f;
+	AlignmentWeight = 0.3f;
+	ReplanInterval = 1.f;
+	ReplanDistance = 300.f;
+	MaxReplansPerFrame = 4;
+	AcceptanceRadius = 100.f;
+
+	NextSquadId = 0;
+}
+
+void AWarriorSquadService::AssignToSquad(AWarriorCombatCharacter* Warrior)
+{
+	if (Warrior == nullptr || SquadIds.Contains(Warrior))
+	{
+		return;
+	}
+
+	const FVector Location = Warrior->GetActorLocation();
+	int32 BestId = INDEX_NONE;
+	float BestDistSq = FMath::Square(JoinRadius);
+	for (TPair<int32, FSquad>& Pair : Squads)
+	{
+		const AWarriorCombatCharacter* Leader = Pair.Value.Members.Num() > 0 ? Pair.Value.Members[0].Get() : nullptr;
+		if (Leader == nullptr || Leader->Team != Warrior->Team || Pair.Value.Members.Num() >= MaxSquadSize)
+		{
+			continue;
+		}
+
+		const float DistSq = FVector::DistSquared(Leader->GetActorLocation(), Location);
+		if (DistSq < BestDistSq)
+		{
+			BestDistSq = DistSq;
+			BestId = Pair.Key;
+		}
+	}
+
+	if (BestId == INDEX_NONE)
+	{
+		BestId = NextSquadId++;
+		Squads.Add(BestId);
+	}
+
+	Squads[BestId].Members.Add(Warrior);
+	SquadIds.Add(Warrior, BestId);
+}
+
+void AWarriorSquadService::RemoveFromSquad(AWarriorCombatCharacter* Warrior)
+{
+	int32 SquadId;
+	if (!SquadIds.RemoveAndCopyValue(Warrior, SquadId))
+	{
+		return;
+	}
+
+	FSquad& Squad = Squads[SquadId];
+
+	// Keeps the order so the next member inherits the lead
+	Squad.Members.Remove(Warrior);
+	if (Squad.Members.Num() == 0)
+	{
+		Squads.Remove(SquadId);
+	}
+	else
+	{
+		Squad.bHasPath = false;
+	}
+}
+
+int32 AWarriorSquadService::GetSquadId(const AWarriorCombatCharacter* Warrior) const
+{
+	const int32* SquadId = SquadIds.Find(Warrior);
+	return SquadId ? *SquadId : INDEX_NONE;
+}
+
+void AWarriorSquadService::SetSquadGoal(int32 SquadId, const FVector& Goal)
+{
+	if (FSquad* Squad = Squads.Find(SquadId))
+	{
+		Squad->Goal = Goal;
+		Squad->bHasGoal = true;
+	}
+}
+
+void AWarriorSquadService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorSquadTick);
+
+	Super::Tick(DeltaTime);
+
+	int32 ReplansLeft = MaxReplansPerFrame;
+	for (auto It = Squads.CreateIterator(); It; ++It)
+	{
+		FSquad& Squad = It.Value();
+
+		// Destroyed warriors unregister themselves, this only catches the ones that didn't get the chance
+		Squad.Members.RemoveAll([](const TWeakObjectPtr<AWarriorCombatCharacter>& Member) { return !Member.IsValid(); });
+		if (Squad.Members.Num() == 0)
+		{
+			It.RemoveCurrent();
+			continue;
+		}
+
+		AWarriorCombatCharacter* Leader = Squad.Members[0].Get();
+		Squad.TimeSinceReplan += DeltaTime;
+
+		FVector Destination;
+		if (GetSquadDestination(Squad, Destination))
+		{
+			const bool bNeedsReplan = !Squad.bHasPath
+				|| Squad.TimeSinceReplan >= ReplanInterval
+				|| FVector::DistSquared(Destination, Squad.PlannedGoal) > FMath::Square(ReplanDistance);
+			if (bNeedsReplan && !Squad.bPathPending && ReplansLeft > 0)
+			{
+				--ReplansLeft;
+				Replan(It.Key(), Squad, Destination);
+			}
+		}
+		else
+		{
+			Squad.bHasPath = false;
+		}
+
+		SteerLeader(Squad, Leader);
+		SteerMembers(Squad);
+	}
+}
+
+bool AWarriorSquadService::GetSquadDestination(const FSquad& Squad, FVector& OutDestination) const
+{
+	const AWarriorCombatCharacter* Leader = Squad.Members[0].Get();
+	if (const AActor* Target = Leader->GetCurrentTarget())
+	{
+		OutDestination = Target->GetActorLocation();
+		return true;
+	}
+	if (Squad.bHasGoal)
+	{
+		OutDestination = Squad.Goal;
+		return true;
+	}
+	return false;
+}
+
+void AWarriorSquadService::Replan(int32 SquadId, FSquad& Squad, const FVector& Destination)
+{
+	INC_DWORD_STAT(STAT_WarriorSquadPathRequests);
+
+	AWarriorCombatCharacter* Leader = Squad.Members[0].Get();
+	Squad.PlannedGoal = Destination;
+	Squad.TimeSinceReplan = 0.f;
+	Squad.bPathPending = true;
+
+	AWarriorNavigationService* Navigation = AWarriorWorldService::Get<AWarriorNavigationService>(this);
+	Navigation->RequestPath(Leader->GetActorLocation(), Destination,
+		FWarriorPathDelegate::CreateUObject(this, &AWarriorSquadService::OnSquadPath, SquadId, Destination));
+}
+
+void AWarriorSquadService::OnSquadPath(const TArray<FVector>& Points, int32 SquadId, FVector Destination)
+{
+	// Squad ids are never reused, a disbanded squad just drops its path
+	FSquad* Squad = Squads.Find(SquadId);
+	if (Squad == nullptr)
+	{
+		return;
+	}
+
+	Squad->bPathPending = false;
+	Squad->PathIndex = 0;
+	Squad->PathPoints = Points;
+	if (Squad->PathPoints.Num() == 0)
+	{
+		// No path: head straight for it
+		Squad->PathPoints.Add(Destination);
+	}
+	Squad->bHasPath = true;
+}
+
+void AWarriorSquadService::SteerLeader(FSquad& Squad, AWarriorCombatCharacter* Leader)
+{
+	if (!Squad.bHasPath || !CanSteer(Leader))
+	{
+		return;
+	}
+
+	const FVector Location = Leader->GetActorLocation();
+	while (Squad.PathIndex < Squad.PathPoints.Num() && FVector::DistSquared2D(Squad.PathPoints[Squad.PathIndex], Location) < FMath::Square(AcceptanceRadius))
+	{
+		++Squad.PathIndex;
+	}
+	if (Squad.PathIndex >= Squad.PathPoints.Num())
+	{
+		return;
+	}
+
+	const FVector Direction = (Squad.PathPoints[Squad.PathIndex] - Location).GetSafeNormal2D();
+	Leader->AddMovementInput(Direction, 1.f);
+}
+
+void AWarriorSquadService::SteerMembers(const FSquad& Squad)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorSquadFlocking);
+
+	using namespace WarriorSquad;
+
+	const AWarriorCombatCharacter* Leader = Squad.Members[0].Get();
+	const int32 NumMembers = Squad.Members.Num();
+	if (NumMembers < 2)
+	{
+		return;
+	}
+
+	// Gather positions and velocities once, every member then reads its neighbors 4 at a time
+	const int32 NumPadded = Align(NumMembers, 4);
+	PosX.SetNumUninitialized(NumPadded, false);
+	PosY.SetNumUninitialized(NumPadded, false);
+	VelX.SetNumUninitialized(NumPadded, false);
+	VelY.SetNumUninitialized(NumPadded, false);
+	BatchWarriors.SetNumUninitialized(NumMembers, false);
+	for (int32 Index = 0; Index < NumPadded; ++Index)
+	{
+		AWarriorCombatCharacter* Member = Index < NumMembers ? Squad.Members[Index].Get() : nullptr;
+		const bool bActive = Member && !Member->IsStreamingSuspended();
+		const FVector Location = bActive ? Member->GetActorLocation() : FVector(FarAway, FarAway, 0.f);
+		const FVector Velocity = bActive ? Member->GetVelocity() : FVector::ZeroVector;
+		PosX[Index] = Location.X;
+		PosY[Index] = Location.Y;
+		VelX[Index] = Velocity.X;
+		VelY[Index] = Velocity.Y;
+		if (Index < NumMembers)
+		{
+			BatchWarriors[Index] = Member;
+		}
+	}
+
+	const FVector LeaderLocation = Leader->GetActorLocation();
+	const float LeaderYaw = Leader->GetActorRotation().Yaw;
+	const VectorRegister RadiusSq = VectorSetFloat1(FMath::Square(NeighborRadius));
+	const VectorRegister MinDistSq = VectorSetFloat1(1.f);
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister One = VectorOne();
+
+	for (int32 Index = 1; Index < NumMembers; ++Index)
+	{
+		AWarriorCombatCharacter* Member = BatchWarriors[Index];
+		if (!CanSteer(Member))
+		{
+			continue;
+		}
+
+		const VectorRegister SelfX = VectorSetFloat1(PosX[Index]);
+		const VectorRegister SelfY = VectorSetFloat1(PosY[Index]);
+		VectorRegister SeparationX = Zero;
+		VectorRegister SeparationY = Zero;
+		VectorRegister CohesionX = Zero;
+		VectorRegister CohesionY = Zero;
+		VectorRegister AlignmentX = Zero;
+		VectorRegister AlignmentY = Zero;
+		VectorRegister Count = Zero;
+
+		for (int32 Other = 0; Other < NumPadded; Other += 4)
+		{
+			const VectorRegister DeltaX = VectorSubtract(VectorLoadAligned(&PosX[Other]), SelfX);
+			const VectorRegister DeltaY = VectorSubtract(VectorLoadAligned(&PosY[Other]), SelfY);
+			const VectorRegister DistSq = VectorMultiplyAdd(DeltaX, DeltaX, VectorMultiply(DeltaY, DeltaY));
+
+			// In range and not ourselves
+			const VectorRegister Mask = VectorBitwiseAnd(VectorCompareGT(RadiusSq, DistSq), VectorCompareGE(DistSq, MinDistSq));
+
+			// Push away, stronger when closer: -Delta / DistSq
+			const VectorRegister InvDistSq = VectorReciprocal(VectorMax(DistSq, MinDistSq));
+			SeparationX = VectorSubtract(SeparationX, VectorSelect(Mask, VectorMultiply(DeltaX, InvDistSq), Zero));
+			SeparationY = VectorSubtract(SeparationY, VectorSelect(Mask, VectorMultiply(DeltaY, InvDistSq), Zero));
+
+			CohesionX = VectorAdd(CohesionX, VectorSelect(Mask, DeltaX, Zero));
+			CohesionY = VectorAdd(CohesionY, VectorSelect(Mask, DeltaY, Zero));
+			AlignmentX = VectorAdd(AlignmentX, VectorSelect(Mask, VectorLoadAligned(&VelX[Other]), Zero));
+			AlignmentY = VectorAdd(AlignmentY, VectorSelect(Mask, VectorLoadAligned(&VelY[Other]), Zero));
+			Count = VectorAdd(Count, VectorSelect(Mask, One, Zero));
+		}
+
+		FVector Steering = FVector::ZeroVector;
+
+		// Seek the formation slot, slowing down when close
+		const FVector2D Slot = GetSlotOffset(Index).GetRotated(LeaderYaw);
+		const FVector SlotLocation = LeaderLocation + FVector(Slot.X, Slot.Y, 0.f);
+		const FVector ToSlot = FVector(SlotLocation.X - PosX[Index], SlotLocation.Y - PosY[Index], 0.f);
+		Steering += SlotWeight * ToSlot.GetClampedToMaxSize(FormationSpacing) / FormationSpacing;
+
+		const float Neighbors = HorizontalAdd(Count);
+		if (Neighbors > 0.f)
+		{
+			Steering += SeparationWeight * NeighborRadius * FVector(HorizontalAdd(SeparationX), HorizontalAdd(SeparationY), 0.f);
+			Steering += CohesionWeight * FVector(HorizontalAdd(CohesionX), HorizontalAdd(CohesionY), 0.f).GetClampedToMaxSize(NeighborRadius) / NeighborRadius / Neighbors;
+
+			const float MaxSpeed = FMath::Max(Member->GetCharacterMovement()->GetMaxSpeed(), 1.f);
+			Steering += AlignmentWeight * FVector(HorizontalAdd(AlignmentX), HorizontalAdd(AlignmentY), 0.f) / (Neighbors * MaxSpeed);
+		}
+
+		const float Strength = FMath::Min(Steering.Size2D(), 1.f);
+		if (Strength > KINDA_SMALL_NUMBER)
+		{
+			Member->AddMovementInput(Steering.GetSafeNormal2D(), Strength);
+		}
+	}
+}
+
+FVector2D AWarriorSquadService::GetSlotOffset(int32 Slot) const
+{
+	// Wedge: rows of two behind the leader, alternating left and right
+	const int32 Row = (Slot + 1) / 2;
+	const float Side = (Slot % 2) ? -1.f : 1.f;
+	return FVector2D(-Row * FormationSpacing, Side * Row * FormationSpacing);
+}
+
+bool AWarriorSquadService::CanSteer(const AWarriorCombatCharacter* Warrior)
+{
+	return Warrior && !Warrior->IsStreamingSuspended() && !Warrior->IsPlayerControlled() && Warrior->Health > 0.f;
+}
@@ -0,0 +1,290 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorStatusEffectService.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "BoxActor.h"
+#include "GameFramework/Controller.h"
+#include "GameFramework/DamageType.h"
+#include "Math/VectorRegister.h"
+
+DECLARE_CYCLE_STAT(TEXT("Status Effect Tick"), STAT_WarriorStatusEffectTick, STATGROUP_Warrior);
+DECLARE_CYCLE_STAT(TEXT("Status Effect Update"), STAT_WarriorStatusEffectUpdate, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Status Effects Applied"), STAT_WarriorStatusEffectsApplied, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Status Effect Victims"), STAT_WarriorStatusEffectVictims, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Active Status Effects"), STAT_WarriorActiveStatusEffects, STATGROUP_Warrior);
+
+namespace WarriorStatusEffect
+{
+	/** Padding lanes never expire and never tick */
+	static const float Never = 1.e9f;
+}
+
+void AWarriorStatusEffectService::FEffectArrays::Add(int32 TargetSlot, float Magnitude, float Duration, float TickInterval)
+{
+	TargetSlots.Add(TargetSlot);
+	Magnitudes.Add(Magnitude);
+	Remaining.Add(Duration);
+	TickIntervals.Add(TickInterval);
+	TimeToTick.Add(TickInterval);
+	Ticked.Add(0.f);
+}
+
+void AWarriorStatusEffectService::FEffectArrays::RemoveAtSwap(int32 Index)
+{
+	TargetSlots.RemoveAtSwap(Index, 1, false);
+	Magnitudes.RemoveAtSwap(Index, 1, false);
+	Remaining.RemoveAtSwap(Index, 1, false);
+	TickIntervals.RemoveAtSwap(Index, 1, false);
+	TimeToTick.RemoveAtSwap(Index, 1, false);
+	Ticked.RemoveAtSwap(Index, 1, false);
+}
+
+AWarriorStatusEffectService::AWarriorStatusEffectService()
+{
+	// After the arrows hit, like the area damage
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	MaxEffectsPerType = 65536;
+	MinTickInterval = 0.1f;
+}
+
+void AWarriorStatusEffectService::ApplyEffect(AActor* Target, const FWarriorStatusEffectSpec& Spec, AController* Instigator)
+{
+	if (Target == nullptr || Target->IsPendingKill() || !(Target->IsA<AWarriorCombatCharacter>() || Target->IsA<ABoxActor>()))
+	{
+		return;
+	}
+	if (Spec.Type >= EWarriorStatusEffect::Count || Spec.Magnitude <= 0.f || Spec.Duration <= 0.f)
+	{
+		return;
+	}
+
+	FEffectArrays& TypeEffects = Effects[(int32)Spec.Type];
+	if (TypeEffects.Num() >= MaxEffectsPerType)
+	{
+		return;
+	}
+
+	const int32 Slot = FindOrAddTarget(Target);
+	FTarget& TargetData = Targets[Slot];
+	++TargetData.NumEffects;
+	if (Instigator)
+	{
+		TargetData.Instigator = Instigator;
+	}
+
+	const float Magnitude = Spec.Type == EWarriorStatusEffect::Slow ? FMath::Min(Spec.Magnitude, 1.f) : Spec.Magnitude;
+	TypeEffects.Add(Slot, Magnitude, Spec.Duration, FMath::Max(Spec.TickInterval, MinTickInterval));
+	INC_DWORD_STAT(STAT_WarriorStatusEffectsApplied);
+}
+
+void AWarriorStatusEffectService::ApplyEffects(AActor* Target, const TArray<FWarriorStatusEffectSpec>& Specs, AController* Instigator)
+{
+	for (const FWarriorStatusEffectSpec& Spec : Specs)
+	{
+		ApplyEffect(Target, Spec, Instigator);
+	}
+}
+
+void AWarriorStatusEffectService::ClearEffects(AActor* Target)
+{
+	if (const int32* Slot = TargetSlotsByActor.Find(Target))
+	{
+		ReleaseTarget(*Slot);
+	}
+}
+
+int32 AWarriorStatusEffectService::GetNumEffects(EWarriorStatusEffect Type) const
+{
+	return Type < EWarriorStatusEffect::Count ? Effects[(int32)Type].Num() : 0;
+}
+
+int32 AWarriorStatusEffectService::FindOrAddTarget(AActor* Target)
+{
+	if (const int32* Slot = TargetSlotsByActor.Find(Target))
+	{
+		return *Slot;
+	}
+
+	const int32 Slot = FreeTargetSlots.Num() > 0 ? FreeTargetSlots.Pop(false) : Targets.AddDefaulted();
+	FTarget& TargetData = Targets[Slot];
+	TargetData = FTarget();
+	TargetData.Actor = Target;
+	TargetSlotsByActor.Add(Target, Slot);
+	return Slot;
+}
+
+void AWarriorStatusEffectService::SetSlow(FTarget& Target, float Slow)
+{
+	if (Slow == Target.AppliedSlow)
+	{
+		return;
+	}
+
+	Target.AppliedSlow = Slow;
+	// Replicated to the owning client, whose predicted moves must be slowed too
+	if (AWarriorCombatCharacter* Warrior = Cast<AWarriorCombatCharacter>(Target.Actor.Get()))
+	{
+		Warrior->SetSlowFactor(Slow);
+	}
+}
+
+void AWarriorStatusEffectService::ReleaseTarget(int32 Slot)
+{
+	FTarget& Target = Targets[Slot];
+	for (FEffectArrays& TypeEffects : Effects)
+	{
+		for (int32 Index = TypeEffects.Num() - 1; Index >= 0 && Target.NumEffects > 0; --Index)
+		{
+			if (TypeEffects.TargetSlots[Index] == Slot)
+			{
+				TypeEffects.RemoveAtSwap(Index);
+				--Target.NumEffects;
+			}
+		}
+	}
+
+	SetSlow(Target, 0.f);
+	TargetSlotsByActor.Remove(Target.Actor);
+	// An explicitly null actor marks the slot free
+	Target = FTarget();
+	FreeTargetSlots.Add(Slot);
+}
+
+void AWarriorStatusEffectService::UpdateEffects(FEffectArrays& TypeEffects, float DeltaTime)
+{
+	const int32 NumEffects = TypeEffects.Num();
+	const int32 NumLanes = Align(NumEffects, 4);
+	for (auto* Array : { &TypeEffects.Magnitudes, &TypeEffects.Remaining, &TypeEffects.TickIntervals, &TypeEffects.TimeToTick, &TypeEffects.Ticked })
+	{
+		Array->SetNumUninitialized(NumLanes, false);
+	}
+	for (int32 Lane = NumEffects; Lane < NumLanes; ++Lane)
+	{
+		TypeEffects.Magnitudes[Lane] = 0.f;
+		TypeEffects.Remaining[Lane] = WarriorStatusEffect::Never;
+		TypeEffects.TickIntervals[Lane] = 0.f;
+		TypeEffects.TimeToTick[Lane] = WarriorStatusEffect::Never;
+	}
+
+	const VectorRegister Zero = VectorZero();
+	const VectorRegister Delta = VectorSetFloat1(DeltaTime);
+	for (int32 Lane = 0; Lane < NumLanes; Lane += 4)
+	{
+		const VectorRegister Remaining = VectorSubtract(VectorLoadAligned(&TypeEffects.Remaining[Lane]), Delta);
+		VectorRegister TimeToTick = VectorSubtract(VectorLoadAligned(&TypeEffects.TimeToTick[Lane]), Delta);
+
+		// At most one tick per frame, a long frame only delays the next one
+		const VectorRegister Due = VectorCompareGE(Zero, TimeToTick);
+		TimeToTick = VectorAdd(TimeToTick, VectorSelect(Due, VectorLoadAligned(&TypeEffects.TickIntervals[Lane]), Zero));
+
+		VectorStoreAligned(Remaining, &TypeEffects.Remaining[Lane]);
+		VectorStoreAligned(TimeToTick, &TypeEffects.TimeToTick[Lane]);
+		VectorStoreAligned(VectorSelect(Due, VectorLoadAligned(&TypeEffects.Magnitudes[Lane]), Zero), &TypeEffects.Ticked[Lane]);
+	}
+
+	for (auto* Array : { &TypeEffects.Magnitudes, &TypeEffects.Remaining, &TypeEffects.TickIntervals, &TypeEffects.TimeToTick, &TypeEffects.Ticked })
+	{
+		Array->SetNumUninitialized(NumEffects, false);
+	}
+}
+
+void AWarriorStatusEffectService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorStatusEffectTick);
+
+	Super::Tick(DeltaTime);
+
+	if (TargetSlotsByActor.Num() == 0)
+	{
+		return;
+	}
+
+	PendingDamage.Reset();
+	PendingDamage.SetNumZeroed(Targets.Num());
+	StrongestSlow.Reset();
+	StrongestSlow.SetNumZeroed(Targets.Num());
+
+	int32 NumActive = 0;
+	{
+		SCOPE_CYCLE_COUNTER(STAT_WarriorStatusEffectUpdate);
+
+		for (int32 Type = 0; Type < (int32)EWarriorStatusEffect::Count; ++Type)
+		{
+			FEffectArrays& TypeEffects = Effects[Type];
+			UpdateEffects(TypeEffects, DeltaTime);
+
+			// Backwards, so the effect swapped into an expired one's place has already been gathered
+			for (int32 Index = TypeEffects.Num() - 1; Index >= 0; --Index)
+			{
+				const int32 Slot = TypeEffects.TargetSlots[Index];
+				if (Type == (int32)EWarriorStatusEffect::Slow)
+				{
+					if (TypeEffects.Remaining[Index] > 0.f)
+					{
+						StrongestSlow[Slot] = FMath::Max(StrongestSlow[Slot], TypeEffects.Magnitudes[Index]);
+					}
+				}
+				else
+				{
+					PendingDamage[Slot] += TypeEffects.Ticked[Index];
+				}
+
+				if (TypeEffects.Remaining[Index] <= 0.f)
+				{
+					TypeEffects.RemoveAtSwap(Index);
+					--Targets[Slot].NumEffects;
+				}
+			}
+			NumActive += TypeEffects.Num();
+		}
+	}
+	SET_DWORD_STAT(STAT_WarriorActiveStatusEffects, NumActive);
+
+	struct FVictim
+	{
+		AActor* Actor;
+		float Damage;
+		AController* Instigator;
+	};
+	TArray<FVictim> Victims;
+
+	for (int32 Slot = 0; Slot < Targets.Num(); ++Slot)
+	{
+		FTarget& Target = Targets[Slot];
+		if (Target.Actor.IsExplicitlyNull())
+		{
+			continue;
+		}
+
+		AActor* Actor = Target.Actor.Get();
+		if (Actor == nullptr || Actor->IsPendingKill())
+		{
+			ReleaseTarget(Slot);
+			continue;
+		}
+
+		SetSlow(Target, StrongestSlow[Slot]);
+		if (PendingDamage[Slot] > 0.f)
+		{
+			Victims.Add({ Actor, PendingDamage[Slot], Target.Instigator.Get() });
+		}
+		if (Target.NumEffects == 0)
+		{
+			ReleaseTarget(Slot);
+		}
+	}
+
+	// Last, a victim dying clears its effects through ClearEffects
+	INC_DWORD_STAT_BY(STAT_WarriorStatusEffectVictims, Victims.Num());
+	const FDamageEvent DamageEvent(UDamageType::StaticClass());
+	for (const FVictim& Victim : Victims)
+	{
+		if (!Victim.Actor->IsPendingKill())
+		{
+			Victim.Actor->TakeDamage(Victim.Damage, DamageEvent, Victim.Instigator, Victim.Instigator ? Victim.Instigator->GetPawn() : nullptr);
+		}
+	}
+}
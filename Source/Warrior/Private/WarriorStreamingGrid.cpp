@@ -0,0 +1,379 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorStreamingGrid.h"
+#include "Warrior.h"
+#include "Arrow.h"
+#include "WarriorCombatCharacter.h"
+#include "Engine/LevelStreamingDynamic.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerController.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/PlatformMemory.h"
+#include "Misc/App.h"
+#include "Misc/PackageName.h"
+
+DECLARE_CYCLE_STAT(TEXT("Streaming Grid Tick"), STAT_WarriorStreamingGridTick, STATGROUP_Warrior);
+DECLARE_DWORD_ACCUMULATOR_STAT(TEXT("Streaming Cells Visible"), STAT_WarriorStreamingCellsVisible, STATGROUP_Warrior);
+
+AWarriorStreamingGrid::AWarriorStreamingGrid()
+{
+	// Sources have moved by then
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	// 16 x 16 cells of 256m, a 4km battlefield
+	CellSize = 25600.f;
+	NumCells = FIntPoint(16, 16);
+	CellLevelFormat = TEXT("/Game/Battlefield/Cells/Cell_{X}_{Y}");
+	LoadRadius = 1;
+	UnloadRadius = 2;
+	HitchThresholdMs = 50.f;
+
+	FramesSinceCellVisible = MAX_int32;
+	NumCellLoads = 0;
+	NumCellUnloads = 0;
+	NumArrowHandoffs = 0;
+	NumArrowsDropped = 0;
+	NumStreamingFrames = 0;
+	NumStreamingHitches = 0;
+	MaxStreamingFrameMs = 0.f;
+	MaxFrameMs = 0.f;
+	MinUsedPhysical = MAX_uint64;
+	MaxUsedPhysical = 0;
+	TimeToNextMemorySample = 0.f;
+}
+
+FIntPoint AWarriorStreamingGrid::GetCellAt(const FVector& Location) const
+{
+	const FVector Local = Location - GetActorLocation();
+	return FIntPoint(FMath::FloorToInt(Local.X / CellSize), FMath::FloorToInt(Local.Y / CellSize));
+}
+
+FVector AWarriorStreamingGrid::GetCellOrigin(const FIntPoint& Cell) const
+{
+	return GetActorLocation() + FVector(Cell.X * CellSize, Cell.Y * CellSize, 0.f);
+}
+
+bool AWarriorStreamingGrid::IsInGrid(const FIntPoint& Cell) const
+{
+	return Cell.X >= 0 && Cell.Y >= 0 && Cell.X < NumCells.X && Cell.Y < NumCells.Y;
+}
+
+bool AWarriorStreamingGrid::IsCellReady(const FIntPoint& Cell) const
+{
+	if (!IsInGrid(Cell))
+	{
+		return true;
+	}
+	const FCell* Found = Cells.Find(Cell);
+	return Found && Found->State == ECellState::Visible;
+}
+
+void AWarriorStreamingGrid::SpawnInCell(TSubclassOf<AActor> ActorClass, const FIntPoint& Cell, const FTransform& RelativeTransform)
+{
+	if (ActorClass == nullptr)
+	{
+		return;
+	}
+
+	FCell& Entry = Cells.FindOrAdd(Cell);
+	FCellSpawn& Spawn = Entry.Spawns[Entry.Spawns.AddDefaulted()];
+	Spawn.ActorClass = ActorClass;
+	Spawn.RelativeTransform = RelativeTransform;
+
+	if (IsCellReady(Cell))
+	{
+		OnCellVisible(Cell, Entry);
+	}
+}
+
+void AWarriorStreamingGrid::RegisterWarrior(AWarriorCombatCharacter* Warrior)
+{
+	Warriors.AddUnique(Warrior);
+}
+
+void AWarriorStreamingGrid::UnregisterWarrior(AWarriorCombatCharacter* Warrior)
+{
+	Warriors.RemoveSwap(Warrior);
+}
+
+void AWarriorStreamingGrid::RegisterArrow(AArrow* Arrow)
+{
+	FTrackedArrow& Tracked = Arrows[Arrows.AddDefaulted()];
+	Tracked.Arrow = Arrow;
+	Tracked.Cell = GetCellAt(Arrow->GetActorLocation());
+}
+
+void AWarriorStreamingGrid::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorStreamingGridTick);
+
+	Super::Tick(DeltaTime);
+
+	TSet<FIntPoint> WantedCells;
+	GatherCellsAroundPlayers(LoadRadius, WantedCells);
+	TSet<FIntPoint> KeptCells;
+	GatherCellsAroundPlayers(UnloadRadius, KeptCells);
+
+	for (const FIntPoint& Coords : WantedCells)
+	{
+		FCell& Cell = Cells.FindOrAdd(Coords);
+		if (Cell.State == ECellState::Unloaded)
+		{
+			LoadCell(Coords, Cell);
+		}
+	}
+
+	bool bCellBecameVisible = false;
+	int32 NumVisible = 0;
+	for (auto It = Cells.CreateIterator(); It; ++It)
+	{
+		FCell& Cell = It.Value();
+		if (Cell.State == ECellState::Loading && (Cell.Level == nullptr || Cell.Level->IsLevelVisible()))
+		{
+			Cell.State = ECellState::Visible;
+			OnCellVisible(It.Key(), Cell);
+			bCellBecameVisible = true;
+		}
+
+		if (Cell.State != ECellState::Unloaded && !KeptCells.Contains(It.Key()))
+		{
+			UnloadCell(It.Key(), Cell);
+		}
+
+		if (Cell.State == ECellState::Unloaded && Cell.Spawns.Num() == 0)
+		{
+			// Nothing to remember about this cell, keeps memory flat while crossing the map
+			It.RemoveCurrent();
+			continue;
+		}
+
+		NumVisible += Cell.State == ECellState::Visible ? 1 : 0;
+	}
+	SET_DWORD_STAT(STAT_WarriorStreamingCellsVisible, NumVisible);
+
+	// Services aren't replicated, they have authority everywhere: ask the world instead
+	if (GetNetMode() != NM_Client)
+	{
+		UpdateWarriors();
+		UpdateArrows();
+	}
+	UpdateStats(DeltaTime, bCellBecameVisible);
+}
+
+void AWarriorStreamingGrid::GatherCellsAroundPlayers(int32 Radius, TSet<FIntPoint>& OutCells) const
+{
+	for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+	{
+		const APlayerController* Controller = It->Get();
+		const APawn* Pawn = Controller ? Controller->GetPawn() : nullptr;
+		if (Pawn == nullptr)
+		{
+			continue;
+		}
+
+		const FIntPoint Center = GetCellAt(Pawn->GetActorLocation());
+		for (int32 Y = Center.Y - Radius; Y <= Center.Y + Radius; ++Y)
+		{
+			for (int32 X = Center.X - Radius; X <= Center.X + Radius; ++X)
+			{
+				const FIntPoint Cell(X, Y);
+				if (IsInGrid(Cell))
+				{
+					OutCells.Add(Cell);
+				}
+			}
+		}
+	}
+}
+
+void AWarriorStreamingGrid::LoadCell(const FIntPoint& Coords, FCell& Cell)
+{
+	FStringFormatNamedArguments Args;
+	Args.Add(TEXT("X"), Coords.X);
+	Args.Add(TEXT("Y"), Coords.Y);
+	const FString PackageName = FString::Format(*CellLevelFormat, Args);
+
+	Cell.State = ECellState::Loading;
+	Cell.Level = nullptr;
+	if (FPackageName::DoesPackageExist(PackageName))
+	{
+		// Cell levels are authored in world space, no offset
+		bool bSuccess = false;
+		Cell.Level = ULevelStreamingDynamic::LoadLevelInstance(this, PackageName, FVector::ZeroVector, FRotator::ZeroRotator, bSuccess);
+		if (bSuccess && Cell.Level)
+		{
+			CellLevels.Add(Cell.Level);
+		}
+		else
+		{
+			UE_LOG(LogWarrior, Warning, TEXT("Streaming: could not load cell %s"), *PackageName);
+			Cell.Level = nullptr;
+		}
+	}
+	++NumCellLoads;
+}
+
+void AWarriorStreamingGrid::UnloadCell(const FIntPoint& Coords, FCell& Cell)
+{
+	// Targets destroyed in combat stay destroyed, the others come back with the cell
+	Cell.Spawns.RemoveAllSwap([](const FCellSpawn& Spawn) { return Spawn.Actor.IsStale(); });
+	for (FCellSpawn& Spawn : Cell.Spawns)
+	{
+		if (AActor* Actor = Spawn.Actor.Get())
+		{
+			Actor->Destroy();
+		}
+		Spawn.Actor = nullptr;
+	}
+
+	if (Cell.Level)
+	{
+		Cell.Level->SetIsRequestingUnloadAndRemoval(true);
+		CellLevels.RemoveSwap(Cell.Level);
+		Cell.Level = nullptr;
+	}
+	Cell.State = ECellState::Unloaded;
+	++NumCellUnloads;
+}
+
+void AWarriorStreamingGrid::OnCellVisible(const FIntPoint& Coords, FCell& Cell)
+{
+	if (GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	const FTransform CellTransform(GetCellOrigin(Coords));
+	for (FCellSpawn& Spawn : Cell.Spawns)
+	{
+		if (!Spawn.Actor.IsValid())
+		{
+			FActorSpawnParameters SpawnParams;
+			SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButAlwaysSpawn;
+			Spawn.Actor = GetWorld()->SpawnActor<AActor>(Spawn.ActorClass, Spawn.RelativeTransform * CellTransform, SpawnParams);
+		}
+	}
+}
+
+void AWarriorStreamingGrid::UpdateWarriors()
+{
+	for (int32 Index = Warriors.Num() - 1; Index >= 0; --Index)
+	{
+		AWarriorCombatCharacter* Warrior = Warriors[Index].Get();
+		if (Warrior == nullptr)
+		{
+			Warriors.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		// Players keep their own cells loaded, only AI can end up without ground under its feet
+		if (!Warrior->IsPlayerControlled())
+		{
+			const bool bSuspend = !IsCellReady(GetCellAt(Warrior->GetActorLocation()));
+			if (bSuspend != Warrior->IsStreamingSuspended())
+			{
+				Warrior->SetStreamingSuspended(bSuspend);
+			}
+		}
+	}
+}
+
+void AWarriorStreamingGrid::UpdateArrows()
+{
+	for (int32 Index = Arrows.Num() - 1; Index >= 0; --Index)
+	{
+		FTrackedArrow& Tracked = Arrows[Index];
+		AArrow* Arrow = Tracked.Arrow.Get();
+		if (Arrow == nullptr || Arrow->IsPendingKill())
+		{
+			Arrows.RemoveAtSwap(Index, 1, false);
+			continue;
+		}
+
+		const FIntPoint Cell = GetCellAt(Arrow->GetActorLocation());
+		if (Cell == Tracked.Cell)
+		{
+			continue;
+		}
+
+		if (IsCellReady(Cell))
+		{
+			Tracked.Cell = Cell;
+			++NumArrowHandoffs;
+		}
+		else
+		{
+			// Nothing to hit in there and nobody to see it
+			Arrow->Destroy();
+			Arrows.RemoveAtSwap(Index, 1, false);
+			++NumArrowsDropped;
+		}
+	}
+}
+
+void AWarriorStreamingGrid::UpdateStats(float DeltaTime, bool bCellBecameVisible)
+{
+	// Real frame time, not dilated
+	const float FrameMs = FApp::GetDeltaTime() * 1000.f;
+	MaxFrameMs = FMath::Max(MaxFrameMs, FrameMs);
+
+	// Making a level visible finishes during the frame after it was flagged, look at both
+	FramesSinceCellVisible = bCellBecameVisible ? 0 : (FramesSinceCellVisible < MAX_int32 ? FramesSinceCellVisible + 1 : FramesSinceCellVisible);
+	if (FramesSinceCellVisible <= 1)
+	{
+		++NumStreamingFrames;
+		MaxStreamingFrameMs = FMath::Max(MaxStreamingFrameMs, FrameMs);
+		NumStreamingHitches += FrameMs > HitchThresholdMs ? 1 : 0;
+	}
+
+	TimeToNextMemorySample -= FApp::GetDeltaTime();
+	if (TimeToNextMemorySample <= 0.f)
+	{
+		const uint64 UsedPhysical = FPlatformMemory::GetStats().UsedPhysical;
+		MinUsedPhysical = FMath::Min(MinUsedPhysical, UsedPhysical);
+		MaxUsedPhysical = FMath::Max(MaxUsedPhysical, UsedPhysical);
+		TimeToNextMemorySample = 1.f;
+	}
+}
+
+void AWarriorStreamingGrid::DumpStats() const
+{
+	int32 NumLoaded = 0;
+	for (const TPair<FIntPoint, FCell>& Pair : Cells)
+	{
+		NumLoaded += Pair.Value.State != ECellState::Unloaded ? 1 : 0;
+	}
+
+	UE_LOG(LogWarrior, Log, TEXT("Streaming: %d cells loaded, %d loads, %d unloads"), NumLoaded, NumCellLoads, NumCellUnloads);
+	UE_LOG(LogWarrior, Log, TEXT("Streaming: %d warriors, %d arrows tracked, %d arrow handoffs, %d arrows dropped"), Warriors.Num(), Arrows.Num(), NumArrowHandoffs, NumArrowsDropped);
+	UE_LOG(LogWarrior, Log, TEXT("Streaming: %d frames with a cell becoming visible, %d over %.0fms, worst %.1fms (worst frame overall %.1fms)"),
+		NumStreamingFrames, NumStreamingHitches, HitchThresholdMs, MaxStreamingFrameMs, MaxFrameMs);
+	if (MaxUsedPhysical > 0)
+	{
+		UE_LOG(LogWarrior, Log, TEXT("Streaming: used physical memory between %.1fMB and %.1fMB"),
+			MinUsedPhysical / (1024.0 * 1024.0), MaxUsedPhysical / (1024.0 * 1024.0));
+	}
+}
+
+void AWarriorStreamingGrid::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	DumpStats();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+static FAutoConsoleCommandWithWorld WarriorStreamingStatsCommand(
+	TEXT("Warrior.Streaming.Stats"),
+	TEXT("Prints the battlefield streaming stats: cells, arrow handoffs, hitches and memory"),
+	FConsoleCommandWithWorldDelegate::CreateLambda([](UWorld* World)
+	{
+		if (AWarriorStreamingGrid* Grid = AWarriorWorldService::Get<AWarriorStreamingGrid>(World, false))
+		{
+			Grid->DumpStats();
+		}
+		else
+		{
+			UE_LOG(LogWarrior, Log, TEXT("Streaming: this map has no streaming grid"));
+		}
+	}));
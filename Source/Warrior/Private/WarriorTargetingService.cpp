@@ -0,0 +1,263 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorTargetingService.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "Engine/World.h"
+#include "CollisionQueryParams.h"
+
+DECLARE_CYCLE_STAT(TEXT("Targeting Tick"), STAT_WarriorTargetingTick, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targeting Evaluations"), STAT_WarriorTargetingEvaluations, STATGROUP_Warrior);
+DECLARE_DWORD_COUNTER_STAT(TEXT("Targeting LOS Traces"), STAT_WarriorTargetingTraces, STATGROUP_Warrior);
+
+AWarriorTargetingService::AWarriorTargetingService()
+{
+	// Evaluate once movement for the frame is done
+	PrimaryActorTick.TickGroup = TG_PostPhysics;
+
+	MaxEvaluationsPerFrame = 8;
+	MaxLineOfSightChecks = 2;
+	MaxTargetRange = 3000.f;
+	MaxTargetAngle = 75.f;
+	DistanceWeight = 1.f;
+	AngleWeight = 1.f;
+	HealthWeight = 0.5f;
+	GridCellSize = 3000.f;
+	MaxGridUpdatesPerFrame = 64;
+
+	Cursor = 0;
+	GridCursor = 0;
+}
+
+void AWarriorTargetingService::RegisterWarrior(AWarriorCombatCharacter* Warrior)
+{
+	if (Warrior == nullptr || SlotIndices.Contains(Warrior))
+	{
+		return;
+	}
+
+	FTargetSlot Slot;
+	Slot.Warrior = Warrior;
+	Slot.LastEvaluatedTime = -1.f;
+	const int32 Index = Slots.Add(Slot);
+	SlotIndices.Add(Warrior, Index);
+	AddToCell(Index, GetCellAt(Warrior->GetActorLocation()));
+}
+
+void AWarriorTargetingService::UnregisterWarrior(AWarriorCombatCharacter* Warrior)
+{
+	int32 Index;
+	if (!SlotIndices.RemoveAndCopyValue(Warrior, Index))
+	{
+		return;
+	}
+
+	RemoveFromCell(Index);
+	const int32 LastIndex = Slots.Num() - 1;
+	if (Index != LastIndex)
+	{
+		RemoveFromCell(LastIndex);
+	}
+
+	Slots.RemoveAtSwap(Index, 1, false);
+	if (Slots.IsValidIndex(Index))
+	{
+		// The last slot moved into the hole
+		AddToCell(Index, Slots[Index].Cell);
+		if (AWarriorCombatCharacter* Moved = Slots[Index].Warrior.Get())
+		{
+			SlotIndices.Add(Moved, Index);
+		}
+	}
+}
+
+AActor* AWarriorTargetingService::GetTarget(const AWarriorCombatCharacter* Warrior, float MaxStaleness) const
+{
+	const int32* Index = SlotIndices.Find(Warrior);
+	if (Index == nullptr)
+	{
+		return nullptr;
+	}
+
+	const FTargetSlot& Slot = Slots[*Index];
+	if (Slot.LastEvaluatedTime < 0.f || GetWorld()->GetTimeSeconds() - Slot.LastEvaluatedTime > MaxStaleness)
+	{
+		return nullptr;
+	}
+
+	AWarriorCombatCharacter* Target = Cast<AWarriorCombatCharacter>(Slot.Target.Get());
+	return IsValidTarget(Target) ? Target : nullptr;
+}
+
+float AWarriorTargetingService::GetTargetAge(const AWarriorCombatCharacter* Warrior) const
+{
+	const int32* Index = SlotIndices.Find(Warrior);
+	if (Index == nullptr || Slots[*Index].LastEvaluatedTime < 0.f)
+	{
+		return -1.f;
+	}
+	return GetWorld()->GetTimeSeconds() - Slots[*Index].LastEvaluatedTime;
+}
+
+void AWarriorTargetingService::Tick(float DeltaTime)
+{
+	SCOPE_CYCLE_COUNTER(STAT_WarriorTargetingTick);
+
+	Super::Tick(DeltaTime);
+
+	const int32 NumToUpdate = FMath::Min(MaxGridUpdatesPerFrame, Slots.Num());
+	for (int32 Step = 0; Step < NumToUpdate; ++Step)
+	{
+		if (GridCursor >= Slots.Num())
+		{
+			GridCursor = 0;
+		}
+		if (const AWarriorCombatCharacter* Warrior = Slots[GridCursor].Warrior.Get())
+		{
+			const FIntPoint Cell = GetCellAt(Warrior->GetActorLocation());
+			if (Cell != Slots[GridCursor].Cell)
+			{
+				RemoveFromCell(GridCursor);
+				AddToCell(GridCursor, Cell);
+			}
+		}
+		++GridCursor;
+	}
+
+	const int32 NumToEvaluate = FMath::Min(MaxEvaluationsPerFrame, Slots.Num());
+	const float Now = GetWorld()->GetTimeSeconds();
+
+	for (int32 Step = 0; Step < NumToEvaluate; ++Step)
+	{
+		if (Cursor >= Slots.Num())
+		{
+			Cursor = 0;
+		}
+		EvaluateSlot(Slots[Cursor], Now);
+		++Cursor;
+	}
+
+	INC_DWORD_STAT_BY(STAT_WarriorTargetingEvaluations, NumToEvaluate);
+}
+
+void AWarriorTargetingService::EvaluateSlot(FTargetSlot& Slot, float Now)
+{
+	Slot.LastEvaluatedTime = Now;
+	Slot.Target = nullptr;
+
+	AWarriorCombatCharacter* Self = Slot.Warrior.Get();
+	if (!IsValidTarget(Self))
+	{
+		return;
+	}
+
+	const FVector Origin = Self->GetActorLocation();
+	const FVector Forward = Self->GetActorForwardVector();
+	const float CosMaxAngle = FMath::Cos(FMath::DegreesToRadians(MaxTargetAngle));
+	const float RangeSq = FMath::Square(MaxTargetRange);
+
+	// Only the cells the range reaches
+	NearbySlots.Reset();
+	const FIntPoint MinCell = GetCellAt(Origin - FVector(MaxTargetRange, MaxTargetRange, 0.f));
+	const FIntPoint MaxCell = GetCellAt(Origin + FVector(MaxTargetRange, MaxTargetRange, 0.f));
+	for (int32 CellX = MinCell.X; CellX <= MaxCell.X; ++CellX)
+	{
+		for (int32 CellY = MinCell.Y; CellY <= MaxCell.Y; ++CellY)
+		{
+			if (const TArray<int32>* CellSlots = Cells.Find(FIntPoint(CellX, CellY)))
+			{
+				NearbySlots.Append(*CellSlots);
+			}
+		}
+	}
+
+	Candidates.Reset();
+	for (const int32 OtherIndex : NearbySlots)
+	{
+		AWarriorCombatCharacter* Candidate = Slots[OtherIndex].Warrior.Get();
+		if (Candidate == Self || Candidate == nullptr || Candidate->Team == Self->Team || !IsValidTarget(Candidate))
+		{
+			continue;
+		}
+
+		const FVector ToCandidate = Candidate->GetActorLocation() - Origin;
+		const float DistSq = ToCandidate.SizeSquared();
+		if (DistSq > RangeSq || DistSq < KINDA_SMALL_NUMBER)
+		{
+			continue;
+		}
+
+		const float Dist = FMath::Sqrt(DistSq);
+		const float CosAngle = FVector::DotProduct(Forward, ToCandidate / Dist);
+		if (CosAngle < CosMaxAngle)
+		{
+			continue;
+		}
+
+		const float DistanceScore = 1.f - Dist / MaxTargetRange;
+		const float AngleScore = (CosAngle - CosMaxAngle) / FMath::Max(1.f - CosMaxAngle, KINDA_SMALL_NUMBER);
+		const float HealthScore = Candidate->DefaultHealth > 0.f ? 1.f - Candidate->Health / Candidate->DefaultHealth : 0.f;
+
+		FTargetCandidate& Entry = Candidates[Candidates.AddUninitialized()];
+		Entry.Warrior = Candidate;
+		Entry.Score = DistanceWeight * DistanceScore + AngleWeight * AngleScore + HealthWeight * HealthScore;
+	}
+
+	Candidates.Sort([](const FTargetCandidate& A, const FTargetCandidate& B) { return A.Score > B.Score; });
+
+	// Line of sight is the expensive part, only the best few candidates are traced
+	const int32 NumChecks = FMath::Min(MaxLineOfSightChecks, Candidates.Num());
+	for (int32 Index = 0; Index < NumChecks; ++Index)
+	{
+		INC_DWORD_STAT(STAT_WarriorTargetingTraces);
+		if (HasLineOfSight(Self, Candidates[Index].Warrior))
+		{
+			Slot.Target = Candidates[Index].Warrior;
+			return;
+		}
+	}
+}
+
+bool AWarriorTargetingService::HasLineOfSight(const AWarriorCombatCharacter* From, const AActor* To) const
+{
+	static const FName TraceTag(TEXT("WarriorTargetingLOS"));
+	FCollisionQueryParams Params(TraceTag, false, From);
+	Params.AddIgnoredActor(To);
+
+	FVector EyeLocation;
+	FRotator EyeRotation;
+	From->GetActorEyesViewPoint(EyeLocation, EyeRotation);
+
+	return !GetWorld()->LineTraceTestByChannel(EyeLocation, To->GetActorLocation(), ECC_Visibility, Params);
+}
+
+FIntPoint AWarriorTargetingService::GetCellAt(const FVector& Location) const
+{
+	const float InvCellSize = 1.f / FMath::Max(GridCellSize, 100.f);
+	return FIntPoint(FMath::FloorToInt(Location.X * InvCellSize), FMath::FloorToInt(Location.Y * InvCellSize));
+}
+
+void AWarriorTargetingService::AddToCell(int32 SlotIndex, const FIntPoint& Cell)
+{
+	Slots[SlotIndex].Cell = Cell;
+	Cells.FindOrAdd(Cell).Add(SlotIndex);
+}
+
+void AWarriorTargetingService::RemoveFromCell(int32 SlotIndex)
+{
+	const FIntPoint& Cell = Slots[SlotIndex].Cell;
+	if (TArray<int32>* CellSlots = Cells.Find(Cell))
+	{
+		CellSlots->RemoveSingleSwap(SlotIndex, false);
+		if (CellSlots->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+bool AWarriorTargetingService::IsValidTarget(const AWarriorCombatCharacter* Warrior)
+{
+	return Warrior != nullptr && !Warrior->IsPendingKill() && Warrior->Health > 0.f;
+}
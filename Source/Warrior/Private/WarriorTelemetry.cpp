@@ -0,0 +1,441 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorTelemetry.h"
+#include "Warrior.h"
+#include "WarriorCombatCharacter.h"
+#include "HAL/PlatformTLS.h"
+#include "HAL/Runnable.h"
+#include "HAL/RunnableThread.h"
+#include "HAL/IConsoleManager.h"
+#include "HAL/FileManager.h"
+#include "Misc/Paths.h"
+#include "Misc/ScopeLock.h"
+#include "Templates/Atomic.h"
+
+#if PLATFORM_WINDOWS
+#include "Windows/AllowWindowsPlatformTypes.h"
+#include <windows.h>
+#include "Windows/HideWindowsPlatformTypes.h"
+#elif PLATFORM_UNIX || PLATFORM_MAC
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+TAtomic<bool> FWarriorTelemetry::bRecording { false };
+
+namespace WarriorTelemetry
+{
+	/** Records per thread buffer, a power of two */
+	static const uint32 BufferCapacity = 8192;
+
+	/** The file grows by this much every time the mapping is full */
+	static const int64 FileGrowSize = 16 * 1024 * 1024;
+
+	/**
+	 * Single producer (the owning thread), single consumer (the writer thread) ring buffer.
+	 * Head and Tail only ever grow, their difference is the number of pending records.
+	 */
+	struct FThreadBuffer
+	{
+		FWarriorTelemetryRecord Records[BufferCapacity];
+		TAtomic<uint32> Head;
+		TAtomic<uint32> Tail;
+		TAtomic<uint32> Dropped;
+
+		FThreadBuffer() : Head(0), Tail(0), Dropped(0) {}
+	};
+
+	/** Append only file mapped in memory, grown by remapping */
+	class FMappedAppendFile
+	{
+	public:
+		~FMappedAppendFile() { Close(0); }
+
+		bool Open(const FString& Path, int64 InitialSize)
+		{
+#if PLATFORM_WINDOWS
+			FileHandle = CreateFileW(*Path, GENERIC_READ | GENERIC_WRITE, FILE_SHARE_READ, nullptr, CREATE_ALWAYS, FILE_ATTRIBUTE_NORMAL, nullptr);
+			if (FileHandle == INVALID_HANDLE_VALUE)
+			{
+				FileHandle = nullptr;
+				return false;
+			}
+#elif PLATFORM_UNIX || PLATFORM_MAC
+			FileDescriptor = open(TCHAR_TO_UTF8(*Path), O_RDWR | O_CREAT | O_TRUNC, 0644);
+			if (FileDescriptor < 0)
+			{
+				return false;
+			}
+#else
+			return false;
+#endif
+			return Map(InitialSize);
+		}
+
+		/** Makes sure at least RequiredSize bytes are mapped, the data pointer may change */
+		bool Reserve(int64 RequiredSize)
+		{
+			if (RequiredSize <= MappedSize)
+			{
+				return true;
+			}
+			const int64 NewSize = Align(RequiredSize, FileGrowSize);
+			Unmap();
+			return Map(NewSize);
+		}
+
+		/** Unmaps and cuts the file to FinalSize bytes (nothing is cut when 0) */
+		void Close(int64 FinalSize)
+		{
+			Unmap();
+#if PLATFORM_WINDOWS
+			if (FileHandle)
+			{
+				if (FinalSize > 0)
+				{
+					LARGE_INTEGER Position;
+					Position.QuadPart = FinalSize;
+					SetFilePointerEx(FileHandle, Position, nullptr, FILE_BEGIN);
+					SetEndOfFile(FileHandle);
+				}
+				CloseHandle(FileHandle);
+				FileHandle = nullptr;
+			}
+#elif PLATFORM_UNIX || PLATFORM_MAC
+			if (FileDescriptor >= 0)
+			{
+				if (FinalSize > 0)
+				{
+					ftruncate(FileDescriptor, FinalSize);
+				}
+				close(FileDescriptor);
+				FileDescriptor = -1;
+			}
+#endif
+		}
+
+		uint8* GetData() const { return Data; }
+
+	private:
+		bool Map(int64 Size)
+		{
+#if PLATFORM_WINDOWS
+			MappingHandle = CreateFileMappingW(FileHandle, nullptr, PAGE_READWRITE, (DWORD)(Size >> 32), (DWORD)(Size & 0xFFFFFFFF), nullptr);
+			if (MappingHandle == nullptr)
+			{
+				return false;
+			}
+			Data = (uint8*)MapViewOfFile(MappingHandle, FILE_MAP_WRITE, 0, 0, Size);
+#elif PLATFORM_UNIX || PLATFORM_MAC
+			if (ftruncate(FileDescriptor, Size) != 0)
+			{
+				return false;
+			}
+			void* Mapped = mmap(nullptr, Size, PROT_READ | PROT_WRITE, MAP_SHARED, FileDescriptor, 0);
+			Data = Mapped == MAP_FAILED ? nullptr : (uint8*)Mapped;
+#endif
+			MappedSize = Data ? Size : 0;
+			return Data != nullptr;
+		}
+
+		void Unmap()
+		{
+#if PLATFORM_WINDOWS
+			if (Data)
+			{
+				UnmapViewOfFile(Data);
+			}
+			if (MappingHandle)
+			{
+				CloseHandle(MappingHandle);
+				MappingHandle = nullptr;
+			}
+#elif PLATFORM_UNIX || PLATFORM_MAC
+			if (Data)
+			{
+				munmap(Data, MappedSize);
+			}
+#endif
+			Data = nullptr;
+			MappedSize = 0;
+		}
+
+#if PLATFORM_WINDOWS
+		HANDLE FileHandle = nullptr;
+		HANDLE MappingHandle = nullptr;
+#elif PLATFORM_UNIX || PLATFORM_MAC
+		int FileDescriptor = -1;
+#endif
+		uint8* Data = nullptr;
+		int64 MappedSize = 0;
+	};
+
+	/** Drains the thread buffers into the file */
+	class FWriter : public FRunnable
+	{
+	public:
+		bool Open(const FString& Path)
+		{
+			if (!File.Open(Path, FileGrowSize))
+			{
+				return false;
+			}
+
+			FWarriorTelemetryFileHeader& Header = GetHeader();
+			FMemory::Memzero(Header);
+			Header.Magic = FWarriorTelemetryFileHeader::ExpectedMagic;
+			Header.Version = FWarriorTelemetryFileHeader::CurrentVersion;
+			Header.RecordSize = sizeof(FWarriorTelemetryRecord);
+			Header.SecondsPerCycle = FPlatformTime::GetSecondsPerCycle64();
+			Header.StartCycles = FPlatformTime::Cycles64();
+			FCStringAnsi::Strncpy(Header.Schema, "Cycles:u64,Frame:u32,Type:u8,Flags:u8,Reserved:u16,SourceId:u32,TargetId:u32,Value:f32,X:f32,Y:f32,Z:f32", ARRAY_COUNT(Header.Schema));
+			return true;
+		}
+
+		virtual uint32 Run() override
+		{
+			while (!bStopping)
+			{
+				Drain();
+				FPlatformProcess::Sleep(0.005f);
+			}
+			return 0;
+		}
+
+		virtual void Stop() override
+		{
+			bStopping = true;
+		}
+
+		/** Called once the thread is gone, writes what is left and closes the file */
+		void Finish()
+		{
+			if (File.GetData() == nullptr)
+			{
+				File.Close(0);
+				return;
+			}
+			Drain();
+			const uint64 NumRecords = GetHeader().NumRecords;
+			File.Close(sizeof(FWarriorTelemetryFileHeader) + NumRecords * sizeof(FWarriorTelemetryRecord));
+		}
+
+		void AddBuffer(FThreadBuffer* Buffer)
+		{
+			FScopeLock Lock(&BuffersLock);
+			Buffers.Add(Buffer);
+		}
+
+		TAtomic<bool> bStopping { false };
+
+	private:
+		FWarriorTelemetryFileHeader& GetHeader() const { return *(FWarriorTelemetryFileHeader*)File.GetData(); }
+
+		void Drain()
+		{
+			FScopeLock Lock(&BuffersLock);
+			if (File.GetData() == nullptr)
+			{
+				return;
+			}
+
+			uint64 NumRecords = GetHeader().NumRecords;
+			uint64 NumDropped = 0;
+			for (FThreadBuffer* Buffer : Buffers)
+			{
+				const uint32 Tail = Buffer->Tail;
+				const uint32 Head = Buffer->Head;
+				const uint32 Count = Head - Tail;
+				NumDropped += Buffer->Dropped;
+				if (Count == 0)
+				{
+					continue;
+				}
+
+				if (!File.Reserve(sizeof(FWarriorTelemetryFileHeader) + (NumRecords + Count) * sizeof(FWarriorTelemetryRecord)))
+				{
+					// The game thread closes the file on the next Stop or Start
+					UE_LOG(LogWarrior, Error, TEXT("Telemetry: could not grow the file, stopping"));
+					FWarriorTelemetry::bRecording = false;
+					bStopping = true;
+					return;
+				}
+
+				FWarriorTelemetryRecord* Out = (FWarriorTelemetryRecord*)(File.GetData() + sizeof(FWarriorTelemetryFileHeader)) + NumRecords;
+				for (uint32 Index = Tail; Index != Head; ++Index)
+				{
+					*Out++ = Buffer->Records[Index & (BufferCapacity - 1)];
+				}
+				NumRecords += Count;
+
+				// Hands the slots back to the producer
+				Buffer->Tail = Head;
+			}
+
+			// Published last so a reader never sees a record count ahead of the data
+			FWarriorTelemetryFileHeader& Header = GetHeader();
+			Header.NumDropped = NumDropped;
+			FPlatformMisc::MemoryBarrier();
+			Header.NumRecords = NumRecords;
+		}
+
+		FMappedAppendFile File;
+		FCriticalSection BuffersLock;
+		TArray<FThreadBuffer*> Buffers;
+	};
+
+	static FWriter* Writer = nullptr;
+	static FRunnableThread* WriterThread = nullptr;
+	static uint32 TlsSlot = FPlatformTLS::AllocTlsSlot();
+
+	/** Every buffer ever created, they live until the module unloads since their thread may still write */
+	static TArray<TUniquePtr<FThreadBuffer>> AllBuffers;
+	static FCriticalSection AllBuffersLock;
+
+	static FThreadBuffer* GetThreadBuffer()
+	{
+		FThreadBuffer* Buffer = (FThreadBuffer*)FPlatformTLS::GetTlsValue(TlsSlot);
+		if (Buffer == nullptr)
+		{
+			// First event on this thread, the only time Record takes a lock
+			FScopeLock Lock(&AllBuffersLock);
+			Buffer = AllBuffers.Add_GetRef(MakeUnique<FThreadBuffer>()).Get();
+			FPlatformTLS::SetTlsValue(TlsSlot, Buffer);
+			if (Writer)
+			{
+				Writer->AddBuffer(Buffer);
+			}
+		}
+		return Buffer;
+	}
+
+	/** Stops the writer thread and closes the file, the recording flag must already be cleared */
+	static void ShutdownWriter()
+	{
+		if (WriterThread)
+		{
+			WriterThread->Kill(true);
+			delete WriterThread;
+			WriterThread = nullptr;
+		}
+
+		FScopeLock Lock(&AllBuffersLock);
+		if (Writer)
+		{
+			Writer->Finish();
+			delete Writer;
+			Writer = nullptr;
+		}
+	}
+
+	static uint8 GetTeamFlag(const AActor* Actor, uint8 Bit)
+	{
+		const AWarriorCombatCharacter* Warrior = Cast<AWarriorCombatCharacter>(Actor);
+		return Warrior && Warrior->Team ? Bit : 0;
+	}
+}
+
+bool FWarriorTelemetry::Start(const FString& Path)
+{
+	using namespace WarriorTelemetry;
+
+	if (bRecording)
+	{
+		return true;
+	}
+	ShutdownWriter();
+
+	const FString FilePath = Path.IsEmpty()
+		? FPaths::ProfilingDir() / FString::Printf(TEXT("WarriorTelemetry-%s.bin"), *FDateTime::Now().ToString())
+		: Path;
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(FilePath), true);
+
+	FWriter* NewWriter = new FWriter();
+	if (!NewWriter->Open(FPaths::ConvertRelativePathToFull(FilePath)))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("Telemetry: could not map %s"), *FilePath);
+		delete NewWriter;
+		return false;
+	}
+
+	{
+		// Threads that recorded in an earlier session keep their buffer
+		FScopeLock Lock(&AllBuffersLock);
+		for (const TUniquePtr<FThreadBuffer>& Buffer : AllBuffers)
+		{
+			Buffer->Tail = (uint32)Buffer->Head;
+			Buffer->Dropped = 0;
+			NewWriter->AddBuffer(Buffer.Get());
+		}
+		Writer = NewWriter;
+	}
+
+	WriterThread = FRunnableThread::Create(Writer, TEXT("WarriorTelemetryWriter"), 0, TPri_BelowNormal);
+	bRecording = true;
+	UE_LOG(LogWarrior, Log, TEXT("Telemetry: recording to %s"), *FilePath);
+	return true;
+}
+
+void FWarriorTelemetry::Stop()
+{
+	// The writer may have stopped the recording itself, its file still has to be closed
+	bRecording = false;
+	WarriorTelemetry::ShutdownWriter();
+}
+
+void FWarriorTelemetry::RecordEvent(EWarriorTelemetryEvent Type, const AActor* Source, const AActor* Target, float Value, const FVector& Location)
+{
+	using namespace WarriorTelemetry;
+
+	FThreadBuffer* Buffer = GetThreadBuffer();
+	const uint32 Head = Buffer->Head;
+	if (Head - (uint32)Buffer->Tail >= BufferCapacity)
+	{
+		++Buffer->Dropped;
+		return;
+	}
+
+	FWarriorTelemetryRecord& Record = Buffer->Records[Head & (BufferCapacity - 1)];
+	Record.Cycles = FPlatformTime::Cycles64();
+	Record.Frame = (uint32)GFrameCounter;
+	Record.Type = (uint8)Type;
+	Record.Flags = GetTeamFlag(Source, 1) | GetTeamFlag(Target, 2);
+	Record.Reserved = 0;
+	Record.SourceId = Source ? Source->GetUniqueID() : 0;
+	Record.TargetId = Target ? Target->GetUniqueID() : 0;
+	Record.Value = Value;
+	Record.X = Location.X;
+	Record.Y = Location.Y;
+	Record.Z = Location.Z;
+
+	// Publishes the record to the writer
+	Buffer->Head = Head + 1;
+}
+
+const TCHAR* FWarriorTelemetry::GetEventName(uint8 Type)
+{
+	switch ((EWarriorTelemetryEvent)Type)
+	{
+	case EWarriorTelemetryEvent::AttackPressed:	return TEXT("AttackPressed");
+	case EWarriorTelemetryEvent::ArrowSpawned:	return TEXT("ArrowSpawned");
+	case EWarriorTelemetryEvent::ArrowHit:		return TEXT("ArrowHit");
+	case EWarriorTelemetryEvent::DamageApplied:	return TEXT("DamageApplied");
+	case EWarriorTelemetryEvent::Death:			return TEXT("Death");
+	default:									return TEXT("Unknown");
+	}
+}
+
+static FAutoConsoleCommand WarriorTelemetryStartCommand(
+	TEXT("Warrior.Telemetry.Start"),
+	TEXT("Starts recording combat telemetry. Optional argument: output file"),
+	FConsoleCommandWithArgsDelegate::CreateLambda([](const TArray<FString>& Args)
+	{
+		FWarriorTelemetry::Start(Args.Num() > 0 ? Args[0] : FString());
+	}));
+
+static FAutoConsoleCommand WarriorTelemetryStopCommand(
+	TEXT("Warrior.Telemetry.Stop"),
+	TEXT("Stops recording combat telemetry and closes the file"),
+	FConsoleCommandDelegate::CreateStatic(&FWarriorTelemetry::Stop));
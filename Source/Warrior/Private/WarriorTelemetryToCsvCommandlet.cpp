@@ -0,0 +1,87 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorTelemetryToCsvCommandlet.h"
+#include "Warrior.h"
+#include "WarriorTelemetry.h"
+#include "HAL/FileManager.h"
+#include "HAL/PlatformFilemanager.h"
+#include "Async/MappedFileHandle.h"
+#include "Misc/Paths.h"
+
+UWarriorTelemetryToCsvCommandlet::UWarriorTelemetryToCsvCommandlet()
+{
+	IsClient = false;
+	IsServer = false;
+	IsEditor = false;
+	LogToConsole = true;
+}
+
+int32 UWarriorTelemetryToCsvCommandlet::Main(const FString& Params)
+{
+	FString InPath;
+	if (!FParse::Value(*Params, TEXT("In="), InPath))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorTelemetryToCsv: -In= is required"));
+		return 1;
+	}
+
+	FString OutPath = FPaths::ChangeExtension(InPath, TEXT("csv"));
+	FParse::Value(*Params, TEXT("Out="), OutPath);
+
+	// Mapped read only, the files can be much larger than what we want to load at once
+	TUniquePtr<IMappedFileHandle> MappedFile(FPlatformFileManager::Get().GetPlatformFile().OpenMapped(*InPath));
+	TUniquePtr<IMappedFileRegion> Region(MappedFile ? MappedFile->MapRegion() : nullptr);
+	if (Region == nullptr || Region->GetMappedSize() < (int64)sizeof(FWarriorTelemetryFileHeader))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorTelemetryToCsv: could not read %s"), *InPath);
+		return 1;
+	}
+
+	const FWarriorTelemetryFileHeader& Header = *(const FWarriorTelemetryFileHeader*)Region->GetMappedPtr();
+	if (Header.Magic != FWarriorTelemetryFileHeader::ExpectedMagic
+		|| Header.Version != FWarriorTelemetryFileHeader::CurrentVersion
+		|| Header.RecordSize != sizeof(FWarriorTelemetryRecord))
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorTelemetryToCsv: %s is not a version %d telemetry file"), *InPath, FWarriorTelemetryFileHeader::CurrentVersion);
+		return 1;
+	}
+
+	// A file from a crashed session has a valid header but may be cut short
+	const int64 AvailableRecords = (Region->GetMappedSize() - (int64)sizeof(FWarriorTelemetryFileHeader)) / (int64)sizeof(FWarriorTelemetryRecord);
+	const int64 NumRecords = FMath::Min<int64>(Header.NumRecords, AvailableRecords);
+	const FWarriorTelemetryRecord* Records = (const FWarriorTelemetryRecord*)(Region->GetMappedPtr() + sizeof(FWarriorTelemetryFileHeader));
+
+	TUniquePtr<FArchive> Out(IFileManager::Get().CreateFileWriter(*OutPath));
+	if (Out == nullptr)
+	{
+		UE_LOG(LogWarrior, Error, TEXT("WarriorTelemetryToCsv: could not write %s"), *OutPath);
+		return 1;
+	}
+
+	auto WriteLine = [&Out](const FString& Line)
+	{
+		FTCHARToUTF8 Utf8(*Line);
+		Out->Serialize((void*)Utf8.Get(), Utf8.Length());
+		Out->Serialize((void*)"\n", 1);
+	};
+
+	WriteLine(TEXT("Seconds,Frame,Event,SourceTeam,TargetTeam,SourceId,TargetId,Value,X,Y,Z"));
+	for (int64 Index = 0; Index < NumRecords; ++Index)
+	{
+		const FWarriorTelemetryRecord& Record = Records[Index];
+		WriteLine(FString::Printf(TEXT("%.6f,%u,%s,%d,%d,%u,%u,%g,%.1f,%.1f,%.1f"),
+			(double)(Record.Cycles - Header.StartCycles) * Header.SecondsPerCycle,
+			Record.Frame,
+			FWarriorTelemetry::GetEventName(Record.Type),
+			(Record.Flags & 1) ? 1 : 0,
+			(Record.Flags & 2) ? 1 : 0,
+			Record.SourceId,
+			Record.TargetId,
+			Record.Value,
+			Record.X, Record.Y, Record.Z));
+	}
+
+	UE_LOG(LogWarrior, Display, TEXT("WarriorTelemetryToCsv: %lld records (%llu dropped while recording) written to %s"), NumRecords, Header.NumDropped, *OutPath);
+	return 0;
+}
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+
+#include "WarriorWorldService.h"
+#include "EngineUtils.h"
+
+TMap<TPair<TWeakObjectPtr<UWorld>, UClass*>, TWeakObjectPtr<AWarriorWorldService>> AWarriorWorldService::Services;
+
+AWarriorWorldService::AWarriorWorldService()
+{
+	// Services do their batched work in Tick, the derived class decides the tick group
+	PrimaryActorTick.bCanEverTick = true;
+	PrimaryActorTick.bStartWithTickEnabled = true;
+
+	// Every machine runs its own copy of the services it needs
+	bReplicates = false;
+}
+
+AWarriorWorldService* AWarriorWorldService::GetService(const UObject* WorldContextObject, UClass* ServiceClass, bool bCreateIfMissing)
+{
+	UWorld* World = GEngine ? GEngine->GetWorldFromContextObject(WorldContextObject, EGetWorldErrorMode::ReturnNull) : nullptr;
+	if (World == nullptr)
+	{
+		return nullptr;
+	}
+
+	const TPair<TWeakObjectPtr<UWorld>, UClass*> Key(World, ServiceClass);
+	if (TWeakObjectPtr<AWarriorWorldService>* Found = Services.Find(Key))
+	{
+		if (AWarriorWorldService* Service = Found->Get())
+		{
+			if (!Service->IsPendingKill())
+			{
+				return Service;
+			}
+		}
+	}
+
+	// A placed service that didn't begin play yet, only costs a lookup of the objects of that class
+	for (TActorIterator<AWarriorWorldService> It(World, ServiceClass); It; ++It)
+	{
+		if (!It->IsPendingKill())
+		{
+			Services.Add(Key, *It);
+			return *It;
+		}
+	}
+
+	if (!bCreateIfMissing || !World->IsGameWorld() || World->bIsTearingDown)
+	{
+		return nullptr;
+	}
+
+	// Drop the entries of worlds that went away (PIE sessions, travelled maps)
+	for (auto It = Services.CreateIterator(); It; ++It)
+	{
+		if (!It.Key().Key.IsValid() || !It.Value().IsValid())
+		{
+			It.RemoveCurrent();
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	AWarriorWorldService* Service = World->SpawnActor<AWarriorWorldService>(ServiceClass, FTransform::Identity, SpawnParams);
+	if (Service)
+	{
+		Services.Add(Key, Service);
+	}
+	return Service;
+}
+
+void AWarriorWorldService::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Placed services (and Blueprint subclasses) are found through any of their native classes
+	for (UClass* Class = GetClass(); Class && Class != AWarriorWorldService::StaticClass(); Class = Class->GetSuperClass())
+	{
+		TWeakObjectPtr<AWarriorWorldService>& Entry = Services.FindOrAdd(TPair<TWeakObjectPtr<UWorld>, UClass*>(GetWorld(), Class));
+		if (!Entry.IsValid())
+		{
+			Entry = this;
+		}
+	}
+}
+
+void AWarriorWorldService::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	for (UClass* Class = GetClass(); Class && Class != AWarriorWorldService::StaticClass(); Class = Class->GetSuperClass())
+	{
+		const TPair<TWeakObjectPtr<UWorld>, UClass*> Key(GetWorld(), Class);
+		if (Services.FindRef(Key).Get() == this)
+		{
+			Services.Remove(Key);
+		}
+	}
+
+	Super::EndPlay(EndPlayReason);
+}
@@ -4,6 +4,7 @@
 
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
+#include "WarriorStatusEffectService.h"
 #include "Arrow.generated.h"
 
 UCLASS()
@@ -27,6 +28,12 @@ public:
 	UFUNCTION()
 	void OnHit(UPrimitiveComponent* HitComp, AActor* OtherActor, UPrimitiveComponent* OtherComp, FVector NormalImpulse, const FHitResult& Hit);
 
+	/** Hit of the arrow, from OnHit or from the fixed rate sweeps of AWarriorArrowPhysicsService. Destroys it */
+	void HandleHit(const FHitResult& Hit);
+
+	/** Deals the damage of a hit, the arrow is already destroyed. Applies Damage to the actor hit */
+	virtual void HandleImpact(const FHitResult& Hit);
+
 	/** Returns CollisionComp subobject **/
 	FORCEINLINE class USphereComponent* GetCollisionComp() const { return CollisionComp; }
 	/** Returns ProjectileMovement subobject **/
@@ -36,6 +43,8 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void Tick(float DeltaTime) override;
@@ -43,4 +52,15 @@ public:
 	UFUNCTION(BlueprintCallable)
 		void DamageCustomFunction();
 
+	/** Damage applied to the actor hit */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Projectile)
+	float Damage;
+
+	/** Applied to the actor hit, on top of Damage */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Projectile)
+	TArray<FWarriorStatusEffectSpec> StatusEffects;
+
+	/** Latency trace of the attack that fired it, 0 if none */
+	uint32 LatencyTraceId;
+
 };
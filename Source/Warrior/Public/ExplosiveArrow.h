@@ -0,0 +1,34 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Arrow.h"
+#include "ExplosiveArrow.generated.h"
+
+/**
+ * Arrow exploding on impact.
+ * Damage is dealt to every warrior and box within DamageRadius, falling off from InnerRadius, through
+ * AWarriorAreaDamageService so the explosions of a volley are resolved together.
+ */
+UCLASS()
+class WARRIOR_API AExplosiveArrow : public AArrow
+{
+	GENERATED_BODY()
+
+public:
+	AExplosiveArrow();
+
+	virtual void HandleImpact(const FHitResult& Hit) override;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Explosion)
+	float DamageRadius;
+
+	/** Full damage within this distance */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Explosion)
+	float InnerRadius;
+
+	/** Fraction of Damage dealt at DamageRadius */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=Explosion)
+	float MinDamageFraction;
+};
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorAimService.generated.h"
+
+class AWarriorCombatCharacter;
+
+/**
+ * Lead aiming for AI archers.
+ * Shots are queued during the frame and solved together once the targets have moved: the
+ * intercept time comes from the closed form quadratic on the relative position and the target
+ * velocity, computed 4 shots at a time on a structure of arrays, then a fixed number of passes
+ * lifts the aim to compensate for the arrow drop. Shots without a usable root (target faster
+ * than the arrow, out of range) fall back to an iterative solve.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorAimService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorAimService();
+
+	/** Queues an arrow from SpawnLocation at Target, it is spawned by the shooter once solved this frame */
+	void QueueShot(AWarriorCombatCharacter* Shooter, AActor* Target, const FVector& SpawnLocation);
+
+	/**
+	 * Scalar solve used for the shots the batch rejects: fixed point iteration on the flight time.
+	 * Returns false if it does not converge within FlightLimit, OutAim is then the drop compensated
+	 * direction to the current target position.
+	 */
+	bool SolveIterative(const FVector& Delta, const FVector& TargetVelocity, float ArrowSpeed, float ArrowGravityZ, float FlightLimit, FVector& OutAim) const;
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Aim straight at the target instead of leading it, for comparison */
+	UPROPERTY(EditAnywhere, config, Category=Aim)
+	bool bLeadTargets;
+
+	/** Passes correcting the closed form solution for the arrow drop */
+	UPROPERTY(EditAnywhere, config, Category=Aim)
+	int32 GravityPasses;
+
+	/** Iterations of the fallback solve */
+	UPROPERTY(EditAnywhere, config, Category=Aim)
+	int32 MaxFallbackIterations;
+
+	/** The fallback solve stops once the flight time changes by less than this (in seconds) */
+	UPROPERTY(EditAnywhere, config, Category=Aim)
+	float FallbackTolerance;
+
+private:
+	struct FShot
+	{
+		TWeakObjectPtr<AWarriorCombatCharacter> Shooter;
+		TWeakObjectPtr<AActor> Target;
+		FVector SpawnLocation;
+	};
+
+	/** Closed form solve of the first NumLanes lanes, fills the aim arrays and one fallback bit mask per group of 4 lanes */
+	void SolveBatch(int32 NumLanes);
+
+	TArray<FShot> PendingShots;
+
+	/** Structure of arrays for the SIMD pass, padded to a multiple of 4 */
+	TArray<float, TAlignedHeapAllocator<16>> DeltaX;
+	TArray<float, TAlignedHeapAllocator<16>> DeltaY;
+	TArray<float, TAlignedHeapAllocator<16>> DeltaZ;
+	TArray<float, TAlignedHeapAllocator<16>> VelX;
+	TArray<float, TAlignedHeapAllocator<16>> VelY;
+	TArray<float, TAlignedHeapAllocator<16>> VelZ;
+	TArray<float, TAlignedHeapAllocator<16>> Speed;
+	TArray<float, TAlignedHeapAllocator<16>> GravityZ;
+	TArray<float, TAlignedHeapAllocator<16>> MaxTime;
+
+	/** Results: aim vector from the spawn location, and lanes left to the fallback */
+	TArray<float, TAlignedHeapAllocator<16>> AimX;
+	TArray<float, TAlignedHeapAllocator<16>> AimY;
+	TArray<float, TAlignedHeapAllocator<16>> AimZ;
+	TArray<int32> FallbackMasks;
+};
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorAreaDamageService.generated.h"
+
+class AController;
+
+/** One radial damage impact, damage falls off linearly from InnerRadius to Radius */
+struct FWarriorExplosion
+{
+	FVector Origin = FVector::ZeroVector;
+	float Radius = 0.f;
+	float InnerRadius = 0.f;
+	float Damage = 0.f;
+	/** Fraction of Damage dealt at Radius */
+	float MinDamageFraction = 0.f;
+	TWeakObjectPtr<AActor> Causer;
+	TWeakObjectPtr<AController> Instigator;
+	/** Usually the shooter, never damaged by its own explosion */
+	TWeakObjectPtr<AActor> IgnoreActor;
+};
+
+/**
+ * Radial damage of all the explosions of a frame in one pass.
+ * Impacts are queued during the frame; after physics, explosions whose spheres touch are merged
+ * in clusters, each cluster runs one overlap query for its bounding sphere, and every warrior or
+ * box found gets the sum of the falloff damage of all the explosions that reach it through a
+ * single TakeDamage. A volley of explosive arrows landing together costs a few queries instead of
+ * one query and one TakeDamage per arrow and victim like ApplyRadialDamage.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorAreaDamageService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorAreaDamageService();
+
+	/** Applied after physics this frame */
+	void QueueExplosion(const FWarriorExplosion& Explosion);
+
+	/** Damage of Explosion at Distance from its origin, 0 outside of its radius */
+	static float GetFalloffDamage(const FWarriorExplosion& Explosion, float Distance);
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Explosions are only merged while the cluster stays within this radius, so one query never covers half the map */
+	UPROPERTY(EditAnywhere, config, Category=AreaDamage)
+	float MaxClusterRadius;
+
+private:
+	struct FCluster
+	{
+		TArray<int32, TInlineAllocator<8>> Explosions;
+		FVector Center;
+		float Radius;
+	};
+
+	/** Groups the pending explosions whose spheres overlap, greedily in queue order */
+	void BuildClusters(TArray<FCluster>& OutClusters) const;
+
+	TArray<FWarriorExplosion> PendingExplosions;
+};
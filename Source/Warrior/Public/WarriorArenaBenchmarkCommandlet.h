@@ -0,0 +1,40 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WarriorArenaBenchmarkCommandlet.generated.h"
+
+/**
+ * Compares hosting arenas in one server process against one process per arena.
+ * Runs the same load twice with bot clients (-WarriorBots): first one server with -WarriorArenas=N,
+ * then N servers with one arena each, and prints memory per arena and tick times from the CSV
+ * written by each server (-WarriorLoadTest). An empty server runs first: memory per arena is
+ * what a process uses above it, so the engine and the host map aren't counted as arena memory.
+ *
+ * Usage: -run=WarriorArenaBenchmark -Map=/Game/Maps/ArenaHost [-Arenas=16] [-PlayersPerArena=8]
+ *        [-Seconds=60] [-WarmupSeconds=15] [-Behavior=Random|Scripted] [-Port=7777]
+ */
+UCLASS()
+class UWarriorArenaBenchmarkCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWarriorArenaBenchmarkCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	struct FServerSample
+	{
+		int32 NumRows = 0;
+		double FrameMs = 0.0;
+		double GameTickMs = 0.0;
+		double UsedMB = 0.0;
+	};
+
+	/** Averages the rows written after WarmupSeconds */
+	static FServerSample ReadSamples(const FString& CsvPath, float WarmupSeconds);
+};
@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorArenaManager.generated.h"
+
+class AController;
+class AWarriorCombatCharacter;
+class ULevel;
+class ULevelStreamingDynamic;
+
+/**
+ * Hosts several independent matches in one server world.
+ * Each arena is an instance of ArenaLevel loaded ArenaSpacing apart from the others, far enough that
+ * detection, targeting, arrows and physics never reach from one to the next. Players are assigned to
+ * the emptiest arena when they join and spawn at its player starts; each arena runs its own match.
+ * Started by AWarriorGameMode when the server runs with -WarriorArenas=N.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorArenaManager : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorArenaManager();
+
+	/** Loads Count arena instances */
+	void StartArenas(int32 Count);
+
+	int32 GetNumArenas() const { return Arenas.Num(); }
+
+	/** Arena containing Location, INDEX_NONE outside of every arena */
+	int32 GetArenaAt(const FVector& Location) const;
+
+	/**
+	 * Origin and loaded level instance of the arena containing Location, false outside of every
+	 * loaded arena. Actors spawned into that level go away with the instance when the arena reloads.
+	 */
+	bool GetArenaFrame(const FVector& Location, FVector& OutOrigin, ULevel*& OutLevel) const;
+
+	/** Puts a joining player in the arena with the fewest players, returns INDEX_NONE if they are all full */
+	int32 AssignPlayer(AController* Player);
+
+	/** False once every arena has PlayersPerArena players, checked before a connection is accepted */
+	bool HasFreeSlot() const;
+
+	void RemovePlayer(AController* Player);
+
+	int32 GetPlayerArena(const AController* Player) const;
+
+	/** True once the arena level is visible, players assigned before that are spawned when it is */
+	bool IsArenaReady(int32 ArenaIndex) const;
+
+	/** Next player start of the player's arena, null if the arena has none or isn't ready */
+	AActor* ChoosePlayerStart(AController* Player);
+
+	/** Scores the kill in the arena where it happened */
+	void OnWarriorKilled(AWarriorCombatCharacter* Victim, AActor* Killer);
+
+	/** Prints the state, players, score and actor count of every arena, and the memory they added to the server */
+	void DumpStats() const;
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Level instanced once per arena */
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	FString ArenaLevel;
+
+	/** Distance between arena origins, must be well above the arena size plus the targeting range */
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	float ArenaSpacing;
+
+	/** Arenas are laid out on a grid this many columns wide */
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	int32 ArenaColumns;
+
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	int32 PlayersPerArena;
+
+	/** Players needed before a match starts */
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	int32 MinPlayersToStart;
+
+	/** Match length in seconds */
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	float MatchDuration;
+
+	/** Seconds between the end of a match and the next one */
+	UPROPERTY(EditAnywhere, config, Category=Arena)
+	float RestartDelay;
+
+private:
+	enum class EArenaState : uint8
+	{
+		Loading,
+		WaitingForPlayers,
+		InProgress,
+		Finished,
+	};
+
+	struct FArena
+	{
+		FVector Origin = FVector::ZeroVector;
+		ULevelStreamingDynamic* Level = nullptr;
+		EArenaState State = EArenaState::Loading;
+		TArray<TWeakObjectPtr<AController>> Players;
+		/** Kills scored by each team, indexed by AWarriorCombatCharacter::Team */
+		int32 TeamKills[2] = { 0, 0 };
+		float StateTime = 0.f;
+		int32 NumMatches = 0;
+		int32 NextPlayerStart = 0;
+	};
+
+	void SetState(int32 ArenaIndex, EArenaState State);
+
+	/** Spawns the arena's players that have no pawn */
+	void RestartPlayers(FArena& Arena);
+
+	static const TCHAR* GetStateName(EArenaState State);
+
+	TArray<FArena> Arenas;
+
+	/** Memory used by the server before the arenas were loaded */
+	uint64 BaselineUsedPhysical;
+
+	/** Level streaming objects are UObjects, keep them referenced while they are in use */
+	UPROPERTY(Transient)
+	TArray<ULevelStreamingDynamic*> ArenaLevels;
+};
@@ -0,0 +1,73 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WorldCollision.h"
+#include "WarriorWorldService.h"
+#include "WarriorArrowPhysicsService.generated.h"
+
+class AArrow;
+
+/**
+ * Arrow flight at a fixed rate, decoupled from the frame rate, server only.
+ * Registered arrows stop using their projectile movement: the service integrates them in fixed
+ * steps and sweeps every step with an async sweep, run off the game thread with the other async
+ * traces of the frame. The sweeps are read back the next frame and the hits of all the arrows are
+ * dispatched together. Between steps the actors are placed by interpolating the last two steps.
+ * The same steps are swept whatever the frame rate, so a slow frame neither tunnels nor changes
+ * where an arrow lands; a hit is dispatched one frame after the step that found it.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorArrowPhysicsService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorArrowPhysicsService();
+
+	/** Takes over the flight of Arrow from its projectile movement, false if the service is disabled */
+	bool RegisterArrow(AArrow* Arrow);
+
+	int32 GetNumArrows() const { return Arrows.Num(); }
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Arrows keep their projectile movement when disabled */
+	UPROPERTY(EditAnywhere, config, Category=ArrowPhysics)
+	bool bEnabled;
+
+	/** Steps per second */
+	UPROPERTY(EditAnywhere, config, Category=ArrowPhysics)
+	float StepRate;
+
+	/** Steps beyond this in one frame are dropped, the arrows slow down instead of the frame */
+	UPROPERTY(EditAnywhere, config, Category=ArrowPhysics)
+	int32 MaxStepsPerFrame;
+
+private:
+	struct FSimulatedArrow
+	{
+		TWeakObjectPtr<AArrow> Arrow;
+		/** Last two steps, the actor is placed between them */
+		FVector PreviousLocation;
+		FVector Location;
+		FVector Velocity;
+		float GravityZ;
+		float MaxSpeed;
+		float Radius;
+		/** Sweeps of the steps taken last frame, in step order */
+		TArray<FTraceHandle, TInlineAllocator<4>> Sweeps;
+	};
+
+	/** First blocking hit of the sweeps of the last frame, false if none or the results are gone */
+	bool FindFirstHit(const FSimulatedArrow& Simulated, FHitResult& OutHit) const;
+
+	/** Advances Simulated by one step of StepTime seconds */
+	static void Step(FSimulatedArrow& Simulated, float StepTime);
+
+	TArray<FSimulatedArrow> Arrows;
+
+	/** Time not simulated yet, less than a step */
+	float Accumulator;
+};
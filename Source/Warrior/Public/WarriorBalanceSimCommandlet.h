@@ -0,0 +1,29 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WarriorBalanceSimCommandlet.generated.h"
+
+/**
+ * Monte Carlo balance simulation of team fights, without a world or physics.
+ * Warriors close in until an enemy is inside their detection radius, then shoot arrows at the combo
+ * cadence, with a volley every third attack. Arrows take distance / speed to land and moving targets
+ * may dodge them. Runs every combination of the tuning values given on the command line for every
+ * composition, Runs times each, spread over all cores. Defaults come from the class defaults.
+ *
+ * Usage: -run=WarriorBalanceSim [-Runs=1000] [-Compositions=4v4,3v5] [-Damage=20,25,30] [-Health=100]
+ *        [-ArrowSpeed=2000,3000] [-VolleyInterval=0.2] [-DetectionRadius=300] [-AttackInterval=0.8]
+ *        [-StartDistance=2000] [-MaxSeconds=120] [-Seed=0] [-WarriorClass=/Game/...] [-Csv=Path]
+ */
+UCLASS()
+class UWarriorBalanceSimCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWarriorBalanceSimCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,78 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Tickable.h"
+
+class AWarriorCharacter;
+class APlayerController;
+class UWorld;
+
+/** How the bots pick their inputs */
+enum class EWarriorBotBehavior : uint8
+{
+	/** Random walk with random attacks, reproducible through the seed */
+	Random,
+	/** Every bot plays the same fixed sequence of moves and attacks */
+	Scripted,
+};
+
+/**
+ * Headless bot client used for server capacity tests.
+ * Runs on a game client started with -WarriorBots=N: once connected it adds N-1 split screen
+ * players, so the server sees N players behind one connection, and drives every local warrior
+ * through the same MoveForward/MoveRight/Attack/SpawnProjectileArrow calls as a human player.
+ */
+class WARRIOR_API FWarriorBotDriver : public FTickableGameObject
+{
+public:
+	FWarriorBotDriver(int32 InNumBots, EWarriorBotBehavior InBehavior, int32 InSeed);
+
+	/** Creates the driver from the command line, null if -WarriorBots isn't set */
+	static TUniquePtr<FWarriorBotDriver> CreateFromCommandLine();
+
+	// FTickableGameObject interface
+	virtual void Tick(float DeltaTime) override;
+	virtual bool IsTickable() const override { return NumBots > 0; }
+	virtual TStatId GetStatId() const override;
+	// End of FTickableGameObject interface
+
+private:
+	struct FBotState
+	{
+		float Forward;
+		float Right;
+
+		/** Seconds until the next input change */
+		float TimeToNextDecision;
+
+		/** Seconds until the next attack press */
+		float TimeToNextAttack;
+
+		/** Seconds until the arrow of the current attack is released, negative when not attacking */
+		float TimeToRelease;
+
+		int32 ScriptStep;
+	};
+
+	/** Adds the split screen players, once the first one is connected */
+	void SpawnLocalBots(UWorld* World);
+
+	void DriveBot(APlayerController* Controller, AWarriorCharacter* Warrior, FBotState& State, float DeltaTime);
+
+	void DecideRandom(APlayerController* Controller, FBotState& State);
+
+	void DecideScripted(APlayerController* Controller, FBotState& State);
+
+	int32 NumBots;
+
+	EWarriorBotBehavior Behavior;
+
+	FRandomStream Random;
+
+	/** One entry per local player index */
+	TArray<FBotState> Bots;
+
+	bool bSpawnedLocalBots;
+};
@@ -0,0 +1,232 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Character.h"
+#include "WarriorStatusEffectService.h"
+#include "WarriorCombatCharacter.generated.h"
+
+/**
+ * Everything a warrior needs to fight: health, team, detection, combo attacks and arrows.
+ * AI warriors use this class as is, AWarriorCharacter adds the camera and input for players.
+ */
+UCLASS(config=Game)
+class WARRIOR_API AWarriorCombatCharacter : public ACharacter
+{
+	GENERATED_BODY()
+
+public:
+	/** Moves with a UWarriorMovementComponent */
+	AWarriorCombatCharacter(const FObjectInitializer& ObjectInitializer);
+
+protected:
+	/** Limits the AI auto possession of player side warriors to placed ones, before APawn acts on it */
+	virtual void PostInitializeComponents() override;
+
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+	/** Called when an attack starts, players block their input until the combo is reset */
+	virtual void OnAttackStarted() {}
+
+public:
+	UFUNCTION(BlueprintCallable)
+	void Attack();
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+	bool IsAttacking;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+	bool SaveAttack;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+	int AttackCount;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+		FVector PlayerPosition;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+		FVector AttackPosition;
+
+	UFUNCTION(BlueprintCallable)
+	void ComboAttackSave();
+
+	UFUNCTION(BlueprintCallable)
+	void ResetCombo();
+
+	UFUNCTION(BlueprintCallable)
+	void GoToSwitch();
+
+	UFUNCTION(BlueprintCallable)
+		bool IsMoving();
+
+	
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+		float offset;
+	
+
+	virtual void Tick(float DeltaTime) override;
+
+
+	//Bullet
+
+	/** Projectile class to spawn */
+	UPROPERTY(EditDefaultsOnly, Category=Projectile)
+	TSubclassOf<class AArrow> ProjectileClass;
+
+	UFUNCTION(BlueprintCallable)
+	void SpawnProjectileArrow();
+
+	/** Runs Attack on the server for a remote client, arrows are only spawned by the server */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerAttack();
+
+	/** Arrow notify of a remote client, the server only honors it for a swing it ran itself and has not fired yet */
+	UFUNCTION(Server, Reliable, WithValidation)
+	void ServerSpawnProjectileArrow();
+
+	/** Where arrows are spawned, in front of the character at chest height */
+	FVector GetArrowSpawnLocation() const;
+
+	/** Rotation to shoot from SpawnLocation: towards the current target if there is one, else straight ahead */
+	FRotator GetAimRotation(const FVector& SpawnLocation) const;
+
+	/** Shoots an arrow from SpawnLocation. AI warriors with a target hand the shot to the aim service to lead it, others fire right away */
+	void ShootArrow(const FVector& SpawnLocation);
+
+	/** Spawns the arrow, the aim service calls it once the shot is solved */
+	class AArrow* SpawnArrow(const FVector& SpawnLocation, const FRotator& SpawnRotation);
+
+	//Targeting
+
+	/** Target picked by the targeting service, null if there is none or it is too stale */
+	UFUNCTION(BlueprintCallable)
+	AActor* GetCurrentTarget() const;
+
+	/** Cached targets older than this (in seconds) are not used for aiming */
+	UPROPERTY(EditAnywhere, Category=Targeting)
+	float TargetMaxStaleness;
+
+	//Box Actor for health
+
+	UPROPERTY(EditAnywhere, Category= Box)
+	TSubclassOf<class ABoxActor> Box;
+
+	/** Where the box is spawned: a world location, relative to the warrior's cell on streamed maps, or to its arena's origin */
+	UPROPERTY(EditAnywhere, Category= Box)
+	FVector BoxSpawnLocation;
+
+	//Streaming
+
+	/** Freezes the warrior while the ground under it is streamed out: hidden, no collision, no movement, no animation */
+	void SetStreamingSuspended(bool bSuspend);
+
+	bool IsStreamingSuspended() const { return bStreamingSuspended; }
+
+	//Pooling
+
+	/** Parks a dead warrior in the pool (frozen like a streamed out one and out of the services), or brings it back */
+	void SetPooled(bool bInPool);
+
+	bool IsPooled() const { return bPooled; }
+
+	/** Health and combo back to their spawn values, for a warrior coming out of the pool */
+	void ResetForRespawn();
+
+	//Health properties
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+		float DefaultHealth;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+		float Health;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
+		float HealthPercentage;
+
+	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, class AActor* DamageCauser);
+
+
+	//Detection properties
+
+	/** Sphere collision component */
+	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category=Detectotherobjects)
+	class USphereComponent* CollisionComp;
+	
+	/** called when projectile hits something */
+	
+	UFUNCTION()
+	void OnHit(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
+	
+	//team
+	UPROPERTY(EditAnywhere, BlueprintReadWrite)
+		bool Team;
+
+	UFUNCTION(BlueprintCallable)
+		bool ReturnTeam();
+
+	//delay
+
+	UPROPERTY(EditAnywhere)
+		FTimerHandle Delay;
+
+	UFUNCTION(BlueprintCallable)
+		void TimerEnd();
+
+	UPROPERTY(EditAnywhere)
+		int count;
+
+	UPROPERTY(EditAnywhere)
+		bool AttackOnOff;
+
+	/** Seconds between the arrows of the volley fired at the end of a combo */
+	UPROPERTY(EditAnywhere, Category=Projectile)
+	float VolleyInterval;
+
+	/** Minimum seconds between two swing arrows accepted by the server */
+	UPROPERTY(EditAnywhere, Category=Projectile)
+	float MinArrowInterval;
+
+	/** Applied by the server to what the attack trace hits */
+	UPROPERTY(EditAnywhere, Category=StatusEffect)
+	TArray<FWarriorStatusEffectSpec> MeleeStatusEffects;
+
+	/** Latency trace of the last attack input, handed to the arrows it fires */
+	uint32 LatencyTraceId;
+
+	//Replication
+
+	/** Combo state replicated to teammates, spawned by the server */
+	UPROPERTY(Transient, BlueprintReadOnly, Category=Combo)
+	class AWarriorComboState* ComboState;
+
+	/** Set by the status effects on the server, the movement component slows the warrior by it */
+	void SetSlowFactor(float Slow);
+	float GetSlowFactor() const { return SlowFactor; }
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+private:
+	/** Pushes the combo to ComboState after it changed, server only */
+	void PublishComboState();
+
+	/** Hidden, no collision, no movement, no animation and dormant */
+	void SetFrozen(bool bFrozen);
+
+	/** Targeting, streaming grid and squads, server only; unregistering also clears status effects */
+	void RegisterWithServices();
+	void UnregisterFromServices();
+
+	bool bStreamingSuspended;
+	bool bPooled;
+
+	/** Fraction of walk speed taken away, replicated to the owning client which predicts its moves with it */
+	UPROPERTY(Transient, Replicated)
+	float SlowFactor;
+
+	/** Set by each swing the server runs, cleared by its arrow: the server and the owning client's notifies share it */
+	bool bSwingArrowReady;
+	float LastSwingArrowTime;
+};
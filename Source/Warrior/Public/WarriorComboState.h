@@ -0,0 +1,48 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "WarriorComboState.generated.h"
+
+class AWarriorCombatCharacter;
+
+/**
+ * Combo state of a warrior, replicated to its teammates only.
+ * Kept out of the warrior so enemies never receive it: the replication graph routes it to the
+ * connections of the same team (IsNetRelevantFor does the same without the graph). Dormant until the
+ * combo changes.
+ */
+UCLASS(notplaceable)
+class WARRIOR_API AWarriorComboState : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorComboState();
+
+	/** Copies the combo of Warrior and wakes the actor up if it changed, server only */
+	void Update(const AWarriorCombatCharacter* Warrior);
+
+	virtual bool IsNetRelevantFor(const AActor* RealViewer, const AActor* ViewTarget, const FVector& SrcLocation) const override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** Warrior this is the combo of, also the owner */
+	UPROPERTY(Replicated, BlueprintReadOnly, Category=Combo)
+	AWarriorCombatCharacter* Warrior;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category=Combo)
+	bool Team;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category=Combo)
+	int32 AttackCount;
+
+	UPROPERTY(Replicated, BlueprintReadOnly, Category=Combo)
+	bool bIsAttacking;
+
+	/** The third attack of the combo was reached and the volley is ready */
+	UPROPERTY(Replicated, BlueprintReadOnly, Category=Combo)
+	bool bVolleyReady;
+};
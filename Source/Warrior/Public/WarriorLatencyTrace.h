@@ -0,0 +1,70 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/** Points an attack goes through, in order */
+enum class EWarriorLatencyStage : uint8
+{
+	/** Attack input received by the bindings, or ServerAttack received on a server */
+	Input,
+	/** GoToSwitch picked the combo step */
+	AttackStarted,
+	/** Arrow spawned by the anim notify (SpawnProjectileArrow) */
+	ArrowSpawned,
+	/** AArrow::OnHit */
+	ArrowHit,
+	/** TakeDamage of the actor hit */
+	DamageApplied,
+	Count
+};
+
+/**
+ * Input to hit latency of attacks.
+ * Each attack input gets a trace id that the warrior hands to its arrows; every stage stamps the
+ * time and frame, and the time between two consecutive stages goes to a histogram in milliseconds
+ * and one in frames. A trace lives in one process: on a dedicated server it starts when ServerAttack
+ * arrives. Start with -WarriorLatencyTrace[=File] or Warrior.Latency.Start, Warrior.Latency.Report
+ * prints the histograms, Stop writes them to a CSV. Completed traces are also sent to the CSV
+ * profiler (category WarriorLatency) and, on engines with Unreal Insights, as bookmarks.
+ */
+class WARRIOR_API FWarriorLatencyTrace
+{
+public:
+	/** Clears the histograms and starts tracing, Path is where Stop writes the CSV (defaults to Saved/Profiling/) */
+	static void Start(const FString& Path = FString());
+
+	/** Prints the report, writes the CSV and stops tracing */
+	static void Stop();
+
+	static bool IsTracing() { return bTracing; }
+
+	/** New trace at the Input stage, 0 when not tracing */
+	static uint32 BeginTrace()
+	{
+		return bTracing ? BeginTraceInternal() : 0;
+	}
+
+	/** Stamps a stage of a trace, the first stamp of each stage counts (the first arrow of a volley) */
+	static void Mark(uint32 TraceId, EWarriorLatencyStage Stage)
+	{
+		if (TraceId != 0 && bTracing)
+		{
+			MarkInternal(TraceId, Stage);
+		}
+	}
+
+	static void LogReport();
+
+	/** Writes every histogram bucket as a CSV row */
+	static bool ExportCsv(const FString& Path);
+
+	static const TCHAR* GetSegmentName(int32 Segment);
+
+private:
+	static uint32 BeginTraceInternal();
+	static void MarkInternal(uint32 TraceId, EWarriorLatencyStage Stage);
+
+	static bool bTracing;
+};
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/EngineBaseTypes.h"
+
+class UWorld;
+
+/**
+ * Server side capacity report, enabled with -WarriorLoadTest.
+ * Splits each server frame into game tick (actors) and replication (net flush up to the end of
+ * the frame), samples per connection bandwidth, and appends one CSV row per report interval so a
+ * ramp from 10 to 200 players can be plotted afterwards.
+ */
+class WARRIOR_API FWarriorServerLoadStats
+{
+public:
+	FWarriorServerLoadStats(float InReportInterval, const FString& InCsvPath);
+	~FWarriorServerLoadStats();
+
+	/** Creates the reporter from the command line, null if -WarriorLoadTest isn't set */
+	static TUniquePtr<FWarriorServerLoadStats> CreateFromCommandLine();
+
+	/** Columns written by the reporter, shared with the load test commandlet that reads them back */
+	static const TCHAR* GetCsvHeader();
+
+private:
+	void OnWorldPreActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnWorldPostActorTick(UWorld* World, ELevelTick TickType, float DeltaSeconds);
+	void OnEndFrame();
+
+	void SampleConnections(UWorld* World);
+	void WriteReport(UWorld* World);
+
+	float ReportInterval;
+	FString CsvPath;
+
+	/** World being measured, the dedicated server only has one game world */
+	TWeakObjectPtr<UWorld> MeasuredWorld;
+
+	double FrameStartTime;
+	double ActorTickEndTime;
+	double LastReportTime;
+
+	/** Accumulated over the current report interval */
+	int32 NumFrames;
+	double TotalFrameMs;
+	double MaxFrameMs;
+	double TotalGameTickMs;
+	double TotalReplicationMs;
+	int32 NumConnectionSamples;
+	double TotalConnectionOutBytes;
+	double TotalConnectionInBytes;
+	int32 MaxConnectionOutBytes;
+
+	FDelegateHandle PreActorTickHandle;
+	FDelegateHandle PostActorTickHandle;
+	FDelegateHandle EndFrameHandle;
+};
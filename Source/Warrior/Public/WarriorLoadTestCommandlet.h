@@ -0,0 +1,39 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WarriorLoadTestCommandlet.generated.h"
+
+/**
+ * Finds the player cap of a dedicated server.
+ * Starts a local server with -WarriorLoadTest, then bot client processes (-WarriorBots) over
+ * loopback in steps from MinPlayers to MaxPlayers, and summarizes the CSV written by the server.
+ *
+ * Usage: -run=WarriorLoadTest -Map=/Game/Maps/Arena [-MinPlayers=10] [-MaxPlayers=200] [-Step=10]
+ *        [-BotsPerProcess=10] [-StepSeconds=30] [-Behavior=Random|Scripted] [-BudgetMs=33.3] [-Port=7777]
+ *        [-CompareReplicationGraph]
+ * With -CompareReplicationGraph the ramp runs a second time with -WarriorNoRepGraph on the server and
+ * the replication times of both runs are compared per player count.
+ */
+UCLASS()
+class UWarriorLoadTestCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWarriorLoadTestCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Prints the averaged CSV rows per player count and the largest count that fits in BudgetMs */
+	void Summarize(const FString& CsvPath, float BudgetMs) const;
+
+	/** Prints the replication time per player count with and without the replication graph */
+	void CompareReplication(const FString& GraphCsvPath, const FString& LegacyCsvPath) const;
+
+	/** Average replication ms per player count */
+	static TMap<int32, double> ReadReplicationMs(const FString& CsvPath);
+};
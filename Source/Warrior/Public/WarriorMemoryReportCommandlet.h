@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WarriorMemoryReportCommandlet.generated.h"
+
+/**
+ * Memory budget run for a battle.
+ * Starts a local server with -WarriorMemoryCsv and LLM enabled, connects bot client processes
+ * (-WarriorBots) over loopback for the given time, then prints per class peaks, churn and the
+ * actors that outlived their InitialLifeSpan from the CSV written by the server.
+ *
+ * Usage: -run=WarriorMemoryReport -Map=/Game/Maps/Arena [-Players=50] [-BotsPerProcess=10]
+ *        [-Seconds=120] [-Interval=5] [-BudgetMB=0] [-Port=7777]
+ * The server also writes its LLM CSV (-LLMCSV) to Saved/Profiling/LLM for the allocator view of the tags.
+ */
+UCLASS()
+class UWarriorMemoryReportCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWarriorMemoryReportCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+
+private:
+	/** Prints the summary per class, returns false if the budget was exceeded or actors leaked */
+	bool Summarize(const FString& CsvPath, float BudgetMB) const;
+};
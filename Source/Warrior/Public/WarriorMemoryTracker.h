@@ -0,0 +1,79 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/LowLevelMemTracker.h"
+
+class AActor;
+
+#if ENABLE_LOW_LEVEL_MEM_TRACKER
+/** Project LLM tags of the combat actors, shown with "stat LLMFULL" and in the -LLMCSV output of a -LLM run */
+enum class EWarriorLLMTag : LLM_TAG_TYPE
+{
+	Arrows = (LLM_TAG_TYPE)ELLMTag::ProjectTagStart,
+	Boxes,
+	Warriors,
+};
+
+/** Charges the allocations of the enclosing scope to one of the EWarriorLLMTag tags */
+#define WARRIOR_LLM_SCOPE(Tag) LLM_SCOPE((ELLMTag)EWarriorLLMTag::Tag)
+#else
+#define WARRIOR_LLM_SCOPE(Tag)
+#endif
+
+/** Combat classes counted by the memory report */
+enum class EWarriorMemoryClass : uint8
+{
+	Arrow,
+	Box,
+	Warrior,
+	Count
+};
+
+/** Memory report of one class since the last report */
+struct FWarriorMemoryClassReport
+{
+	int32 Live = 0;
+	int32 Peak = 0;
+	int64 LiveBytes = 0;
+	int64 PeakBytes = 0;
+	/** Totals since the start of the session */
+	int64 Spawned = 0;
+	int64 Destroyed = 0;
+	float SpawnedPerSecond = 0.f;
+	float DestroyedPerSecond = 0.f;
+	/** Actors alive past their InitialLifeSpan, leaked arrows show up here */
+	int32 Overdue = 0;
+};
+
+/**
+ * Live counts, bytes, peaks and churn of the combat actors.
+ * The tracked classes report from BeginPlay and EndPlay. Bytes per instance are measured once per
+ * class on its first instance (object and component sizes, like Warrior.MeasurePawns), the LLM
+ * tags give the allocator view. Report with the Warrior.Memory.Report console command, sample to a
+ * CSV with -WarriorMemoryCsv[=File] [-WarriorMemoryInterval=5], or run -run=WarriorMemoryReport.
+ */
+class WARRIOR_API FWarriorMemoryTracker
+{
+public:
+	/** Registers the LLM tags, before anything of ours is allocated */
+	static void RegisterLLMTags();
+
+	static void OnSpawned(EWarriorMemoryClass Class, AActor* Actor);
+	static void OnDestroyed(EWarriorMemoryClass Class, const AActor* Actor);
+
+	/** Fills one report per class and starts a new churn interval */
+	static void BuildReport(FWarriorMemoryClassReport (&OutReports)[(int32)EWarriorMemoryClass::Count]);
+
+	static void LogReport();
+
+	/** Appends a CSV row per class every Interval seconds until StopCsv, Path defaults to Saved/Profiling/ */
+	static bool StartCsv(const FString& Path = FString(), float Interval = 5.f);
+	static void StopCsv();
+
+	/** Columns of the CSV, shared with the commandlet that reads them back */
+	static const TCHAR* GetCsvHeader();
+
+	static const TCHAR* GetClassName(EWarriorMemoryClass Class);
+};
@@ -0,0 +1,22 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/CharacterMovementComponent.h"
+#include "WarriorMovementComponent.generated.h"
+
+/**
+ * Character movement of the warriors, slowed by their status effects.
+ * The slow is replicated to the owning client, so its predicted moves use the same max speed as
+ * the server and slowed players aren't corrected back.
+ */
+UCLASS()
+class WARRIOR_API UWarriorMovementComponent : public UCharacterMovementComponent
+{
+	GENERATED_BODY()
+
+public:
+	/** Walk speed scaled by the slow factor of the owning warrior */
+	virtual float GetMaxSpeed() const override;
+};
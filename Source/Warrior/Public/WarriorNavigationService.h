@@ -0,0 +1,172 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "AI/Navigation/NavigationTypes.h"
+#include "WarriorNavigationService.generated.h"
+
+class AWarriorCombatCharacter;
+class ANavigationData;
+
+/** Called with the path points, empty if no path was found */
+DECLARE_DELEGATE_OneParam(FWarriorPathDelegate, const TArray<FVector>& /*PathPoints*/);
+
+/**
+ * Asynchronous path queries shared by all AI warriors.
+ * Start and goal are quantized to CellSize cells: requests falling in the same pair of cells are
+ * answered by one navmesh query, and the result is kept for CacheLifetime seconds (or until the
+ * navmesh is rebuilt); a failed query is kept for FailedPathLifetime, so unreachable goals aren't
+ * asked for again every frame. At most MaxQueriesPerFrame queries are sent to the navigation system
+ * per frame, whatever the number of warriors asking.
+ * Also moves chasing warriors along their path with AddMovementInput.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorNavigationService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorNavigationService();
+
+	/** Queues a path request, Callback is always called later from Tick, never from inside this call */
+	void RequestPath(const FVector& Start, const FVector& Goal, const FWarriorPathDelegate& Callback);
+
+	/** Makes an AI warrior run after Target, repathing as it moves */
+	void ChaseTarget(AWarriorCombatCharacter* Warrior, AActor* Target);
+
+	void StopChasing(AWarriorCombatCharacter* Warrior);
+
+	bool IsChasing(const AWarriorCombatCharacter* Warrior) const { return Chasers.Contains(Warrior); }
+
+	/** Drops every cached path, done automatically when the navmesh is rebuilt */
+	void InvalidateCache();
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Size of the cells start and goal are quantized to */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float CellSize;
+
+	/** Queries sent to the navigation system per frame */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	int32 MaxQueriesPerFrame;
+
+	/** Queries waiting for their result at any time */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	int32 MaxQueriesInFlight;
+
+	/** Seconds a path stays in the cache */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float CacheLifetime;
+
+	/** Seconds a failed query stays in the cache, requests between the same cells get no path meanwhile */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float FailedPathLifetime;
+
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	int32 MaxCachedPaths;
+
+	/** Chasers ask for a new path this often, or when the target moved more than RepathDistance */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float RepathInterval;
+
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float RepathDistance;
+
+	/** Chasers give up on targets further than this */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float MaxChaseDistance;
+
+	/** Chasers give up after this many requests in a row found no path, each retried after RepathInterval */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	int32 MaxChaseFailures;
+
+	/** Path points closer than this are considered reached */
+	UPROPERTY(EditAnywhere, config, Category=Navigation)
+	float AcceptanceRadius;
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	struct FPathKey
+	{
+		FIntVector Start;
+		FIntVector Goal;
+
+		bool operator==(const FPathKey& Other) const { return Start == Other.Start && Goal == Other.Goal; }
+		friend uint32 GetTypeHash(const FPathKey& Key) { return HashCombine(GetTypeHash(Key.Start), GetTypeHash(Key.Goal)); }
+	};
+
+	struct FCachedPath
+	{
+		/** Empty for a failed query */
+		TArray<FVector> Points;
+		float Time;
+	};
+
+	struct FPendingQuery
+	{
+		FVector Start;
+		FVector Goal;
+		TArray<FWarriorPathDelegate> Callbacks;
+		bool bSent = false;
+		/** Cache generation when the query was sent, results from an older navmesh are not cached */
+		int32 Generation = 0;
+	};
+
+	struct FReadyCallback
+	{
+		FWarriorPathDelegate Callback;
+		/** Key into the cache, or the points themselves for uncached results */
+		FPathKey Key;
+		TArray<FVector> Points;
+		bool bFromCache;
+	};
+
+	struct FChaser
+	{
+		TWeakObjectPtr<AWarriorCombatCharacter> Warrior;
+		TWeakObjectPtr<AActor> Target;
+		TArray<FVector> Points;
+		int32 PathIndex = 0;
+		FVector RequestedGoal = FVector::ZeroVector;
+		float TimeSinceRequest = 0.f;
+		/** Requests in a row that found no path, the next one waits for RepathInterval or the goal to move */
+		int32 NumFailures = 0;
+		bool bRequestPending = false;
+	};
+
+	FPathKey MakeKey(const FVector& Start, const FVector& Goal) const;
+
+	/** Failed queries expire after FailedPathLifetime, paths after CacheLifetime */
+	bool IsExpired(const FCachedPath& Cached, float Now) const;
+
+	void SendQueries();
+	void DeliverCallbacks();
+	void UpdateChasers(float DeltaTime);
+	void PurgeCache();
+
+	void OnPathFound(uint32 QueryId, ENavigationQueryResult::Type Result, FNavPathSharedPtr Path, FPathKey Key);
+
+	void OnChasePath(const TArray<FVector>& Points, TWeakObjectPtr<AWarriorCombatCharacter> Warrior);
+
+	UFUNCTION()
+	void OnNavigationGenerationFinished(ANavigationData* NavData);
+
+	TMap<FPathKey, FCachedPath> Cache;
+	TMap<FPathKey, FPendingQuery> Pending;
+
+	/** Keys of Pending in request order */
+	TArray<FPathKey> Queue;
+
+	TArray<FReadyCallback> Ready;
+
+	TMap<const AWarriorCombatCharacter*, FChaser> Chasers;
+
+	int32 NumInFlight;
+	int32 CacheGeneration;
+	float TimeToNextPurge;
+};
@@ -0,0 +1,72 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorPawnPool.generated.h"
+
+class AController;
+class AWarriorCombatCharacter;
+
+/**
+ * Reuses dead warriors instead of destroying them and building new ones.
+ * A warrior whose health reaches zero is frozen in place (hidden, no collision, no movement, no
+ * animation, dormant), dropped from the services and unpossessed; Acquire resets its health and
+ * combo, teleports it and possesses it again. Building a character (capsule, movement, skeletal
+ * mesh, anim instance) is what makes a respawn wave hitch, so Prewarm builds them ahead of time.
+ * Server only, pools are per class and team: a warrior never comes back on the other team.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorPawnPool : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorPawnPool();
+
+	/** Parks a dead warrior, returns false if it must be destroyed instead (pool full or disabled) */
+	bool Release(AWarriorCombatCharacter* Warrior);
+
+	/**
+	 * Hands out a pooled warrior of Class and Team at Transform, or spawns one if the pool is empty.
+	 * The warrior is possessed by Controller if given, else if bSpawnAIController by the AI controller
+	 * it had before it was pooled or a new one. Without bSpawnAIController the old AI controller is
+	 * destroyed: the game mode passes null and false, RestartPlayer possesses the pawn itself.
+	 */
+	AWarriorCombatCharacter* Acquire(TSubclassOf<AWarriorCombatCharacter> Class, bool Team, const FTransform& Transform, AController* Controller = nullptr, bool bSpawnAIController = true);
+
+	/** Acquires one AI warrior of Team per transform */
+	void SpawnWave(TSubclassOf<AWarriorCombatCharacter> Class, bool Team, const TArray<FTransform>& Transforms, TArray<AWarriorCombatCharacter*>& OutWarriors);
+
+	/** Builds warriors of Class and Team until Count of them are pooled, meant for loading screens and match starts */
+	void Prewarm(TSubclassOf<AWarriorCombatCharacter> Class, bool Team, int32 Count);
+
+	int32 GetNumPooled(TSubclassOf<AWarriorCombatCharacter> Class, bool Team) const;
+
+	/** Destroys the dead warriors instead when false */
+	UPROPERTY(EditAnywhere, config, Category=Pool)
+	bool bEnabled;
+
+	/** Pooled warriors kept per class and team, the rest are destroyed */
+	UPROPERTY(EditAnywhere, config, Category=Pool)
+	int32 MaxPooledPerClass;
+
+	/** Where prewarmed warriors wait, away from the battle */
+	UPROPERTY(EditAnywhere, config, Category=Pool)
+	FVector PrewarmLocation;
+
+private:
+	struct FPooledWarrior
+	{
+		TWeakObjectPtr<AWarriorCombatCharacter> Warrior;
+		/** AI controller that possessed it, possesses it again on respawn */
+		TWeakObjectPtr<AController> Controller;
+	};
+
+	/** Unpossesses the frozen warrior and adds it to the pool of its class and team */
+	void Park(AWarriorCombatCharacter* Warrior);
+
+	/** Indexed by AWarriorCombatCharacter::Team, then by class */
+	TMap<UClass*, TArray<FPooledWarrior>> Pools[2];
+};
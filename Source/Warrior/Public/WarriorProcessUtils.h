@@ -0,0 +1,16 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "HAL/PlatformProcess.h"
+
+/** Child processes of the commandlets that run servers and bot clients */
+namespace WarriorProcessUtils
+{
+	/** Starts this executable again with Params, hidden and not waiting on it */
+	WARRIOR_API FProcHandle Launch(const FString& Params);
+
+	/** Kills and closes every valid process, then empties Processes */
+	WARRIOR_API void Terminate(TArray<FProcHandle>& Processes);
+}
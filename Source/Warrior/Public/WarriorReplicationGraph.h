@@ -0,0 +1,120 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ReplicationGraph.h"
+#include "WarriorReplicationGraph.generated.h"
+
+class UReplicationGraphNode_ActorList;
+class UReplicationGraphNode_GridSpatialization2D;
+
+/** Which node an actor class is routed to */
+enum class EWarriorClassRepNodeMapping : uint8
+{
+	/** Not routed to a global node: owner only actors handled by the connection node, or not replicated */
+	NotRouted,
+	RelevantAllConnections,
+	/** Spatialized, never moves */
+	Spatialize_Static,
+	/** Spatialized, moves every frame */
+	Spatialize_Dynamic,
+	/** Spatialized, moves or goes dormant */
+	Spatialize_Dormancy,
+	/** Sent to the connections of the same team only */
+	TeamOnly,
+};
+
+/**
+ * Replication graph of the Warrior game.
+ * Warriors, arrows and boxes are placed in a 2D grid so each connection only considers the actors in
+ * the cells around its viewers instead of every actor of the battle. Combo states go to teammates only.
+ * Each class replicates at its own rate (see the frequencies below) and dormant actors are skipped.
+ * Used by the game net driver unless the server runs with -WarriorNoRepGraph.
+ */
+UCLASS(transient, config=Game)
+class WARRIOR_API UWarriorReplicationGraph : public UReplicationGraph
+{
+	GENERATED_BODY()
+
+public:
+	UWarriorReplicationGraph();
+
+	virtual void ResetGameWorldState() override;
+	virtual void InitGlobalActorClassSettings() override;
+	virtual void InitGlobalGraphNodes() override;
+	virtual void InitConnectionGraphNodes(UNetReplicationGraphConnection* RepGraphConnection) override;
+	virtual void RouteAddNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo, FGlobalActorReplicationInfo& GlobalInfo) override;
+	virtual void RouteRemoveNetworkActorToNodes(const FNewReplicatedActorInfo& ActorInfo) override;
+
+	/** Team only actors of a team, 0 or 1 like AWarriorCombatCharacter::Team */
+	const FActorRepListRefView& GetTeamActors(int32 Team) const { return TeamActors[Team]; }
+
+	/** Size of a spatialization cell */
+	UPROPERTY(config)
+	float CellSize;
+
+	/** Minimum corner of the grid, actors below it land in the first cells */
+	UPROPERTY(config)
+	FVector2D SpatialBias;
+
+	/** Warriors further than this from every viewer of a connection are not replicated to it */
+	UPROPERTY(config)
+	float WarriorCullDistance;
+
+	UPROPERTY(config)
+	float BoxCullDistance;
+
+	UPROPERTY(config)
+	float ArrowCullDistance;
+
+	/** Net update frequencies in Hz, converted to a frame period of the server tick rate */
+	UPROPERTY(config)
+	float WarriorNetUpdateFrequency;
+
+	UPROPERTY(config)
+	float ArrowNetUpdateFrequency;
+
+	UPROPERTY(config)
+	float BoxNetUpdateFrequency;
+
+	UPROPERTY(config)
+	float ComboStateNetUpdateFrequency;
+
+	UPROPERTY(config)
+	float PlayerStateNetUpdateFrequency;
+
+private:
+	EWarriorClassRepNodeMapping GetMappingPolicy(UClass* Class);
+
+	void InitClassReplicationInfo(FClassReplicationInfo& Info, UClass* Class, bool bSpatialize, float NetUpdateFrequency) const;
+
+	static int32 GetActorTeam(const AActor* Actor);
+
+	TClassMap<EWarriorClassRepNodeMapping> ClassRepNodePolicies;
+
+	UPROPERTY()
+	UReplicationGraphNode_GridSpatialization2D* GridNode;
+
+	UPROPERTY()
+	UReplicationGraphNode_ActorList* AlwaysRelevantNode;
+
+	FActorRepListRefView TeamActors[2];
+};
+
+/** Actors every connection needs whatever the grid says: its player controllers, their pawns and view targets, and its team's actors */
+UCLASS()
+class WARRIOR_API UWarriorReplicationGraphNode_ForConnection : public UReplicationGraphNode
+{
+	GENERATED_BODY()
+
+public:
+	virtual void NotifyAddNetworkActor(const FNewReplicatedActorInfo& Actor) override {}
+	virtual bool NotifyRemoveNetworkActor(const FNewReplicatedActorInfo& ActorInfo, bool bWarnIfNotFound = true) override { return false; }
+	virtual void NotifyResetAllNetworkActors() override {}
+
+	virtual void GatherActorListsForConnection(const FConnectionGatherActorListParameters& Params) override;
+
+private:
+	FActorRepListRefView ReplicationActorList;
+};
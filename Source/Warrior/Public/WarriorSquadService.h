@@ -0,0 +1,131 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorSquadService.generated.h"
+
+class AWarriorCombatCharacter;
+
+/**
+ * Group movement for AI warriors.
+ * AI warriors are put in squads of up to MaxSquadSize. Only the leader follows a navigation path,
+ * one path query per squad per replan; the other members hold a wedge formation behind it with
+ * separation, cohesion and alignment computed in one batched SIMD pass per squad. The resulting
+ * direction is fed to AddMovementInput, like MoveForward/MoveRight do for players.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorSquadService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorSquadService();
+
+	/** Puts the warrior in the nearest squad with a free slot, or makes it the leader of a new one */
+	void AssignToSquad(AWarriorCombatCharacter* Warrior);
+
+	/** Removes the warrior from its squad, the next member takes over if it was the leader */
+	void RemoveFromSquad(AWarriorCombatCharacter* Warrior);
+
+	/** Squad the warrior belongs to, INDEX_NONE if none */
+	int32 GetSquadId(const AWarriorCombatCharacter* Warrior) const;
+
+	/** Sends a squad to a location, used when the leader has no target of its own */
+	void SetSquadGoal(int32 SquadId, const FVector& Goal);
+
+	virtual void Tick(float DeltaTime) override;
+
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	int32 MaxSquadSize;
+
+	/** Warriors further than this from a squad leader start their own squad */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float JoinRadius;
+
+	/** Distance between formation rows and columns */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float FormationSpacing;
+
+	/** Members closer than this push each other away */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float NeighborRadius;
+
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float SlotWeight;
+
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float SeparationWeight;
+
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float CohesionWeight;
+
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float AlignmentWeight;
+
+	/** Seconds between two path queries of a squad */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float ReplanInterval;
+
+	/** A goal moving further than this forces a replan before the interval */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float ReplanDistance;
+
+	/** Path requests allowed per frame over all squads, the navigation service budgets the queries themselves */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	int32 MaxReplansPerFrame;
+
+	/** Path points closer than this are considered reached */
+	UPROPERTY(EditAnywhere, config, Category=Squad)
+	float AcceptanceRadius;
+
+private:
+	struct FSquad
+	{
+		/** Members[0] is the leader */
+		TArray<TWeakObjectPtr<AWarriorCombatCharacter>> Members;
+
+		TArray<FVector> PathPoints;
+		int32 PathIndex = 0;
+
+		/** Goal set with SetSquadGoal */
+		FVector Goal = FVector::ZeroVector;
+		bool bHasGoal = false;
+
+		/** Goal the current path was planned for */
+		FVector PlannedGoal = FVector::ZeroVector;
+		bool bHasPath = false;
+		bool bPathPending = false;
+		float TimeSinceReplan = 0.f;
+	};
+
+	/** Where the squad is heading this frame: leader target first, then the squad goal */
+	bool GetSquadDestination(const FSquad& Squad, FVector& OutDestination) const;
+
+	/** Requests a new path for the leader, the current one is followed until it comes */
+	void Replan(int32 SquadId, FSquad& Squad, const FVector& Destination);
+
+	void OnSquadPath(const TArray<FVector>& Points, int32 SquadId, FVector Destination);
+
+	void SteerLeader(FSquad& Squad, AWarriorCombatCharacter* Leader);
+
+	/** Formation and flocking for every member but the leader */
+	void SteerMembers(const FSquad& Squad);
+
+	/** Offset of a formation slot in the leader space, slot 0 is the leader */
+	FVector2D GetSlotOffset(int32 Slot) const;
+
+	static bool CanSteer(const AWarriorCombatCharacter* Warrior);
+
+	TMap<int32, FSquad> Squads;
+	TMap<const AWarriorCombatCharacter*, int32> SquadIds;
+	int32 NextSquadId;
+
+	/** Structure of arrays for the SIMD pass, padded to a multiple of 4, reused between squads */
+	TArray<float, TAlignedHeapAllocator<16>> PosX;
+	TArray<float, TAlignedHeapAllocator<16>> PosY;
+	TArray<float, TAlignedHeapAllocator<16>> VelX;
+	TArray<float, TAlignedHeapAllocator<16>> VelY;
+	TArray<AWarriorCombatCharacter*> BatchWarriors;
+};
@@ -0,0 +1,122 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorStatusEffectService.generated.h"
+
+class AController;
+
+UENUM(BlueprintType)
+enum class EWarriorStatusEffect : uint8
+{
+	/** Magnitude damage every tick */
+	Burning,
+	/** Magnitude damage every tick */
+	Bleeding,
+	/** Magnitude is the fraction of walk speed taken away, the strongest slow on a target wins */
+	Slow,
+	Count UMETA(Hidden)
+};
+
+/** An effect applied by an arrow or a melee hit */
+USTRUCT(BlueprintType)
+struct FWarriorStatusEffectSpec
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=StatusEffect)
+	EWarriorStatusEffect Type = EWarriorStatusEffect::Burning;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=StatusEffect)
+	float Magnitude = 5.f;
+
+	/** In seconds */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=StatusEffect)
+	float Duration = 3.f;
+
+	/** Seconds between two damage ticks */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category=StatusEffect)
+	float TickInterval = 0.5f;
+};
+
+/**
+ * Burning, bleeding and slow on warriors and boxes, server only.
+ * Every effect type keeps its active effects in contiguous arrays (target slot, magnitude,
+ * remaining time, tick interval, time to the next tick) updated 4 at a time in one pass per frame.
+ * The ticks of the frame are summed per target and dealt through a single TakeDamage, and expired
+ * effects are swap-removed so the arrays stay dense. Effects stack: each application is its own entry.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorStatusEffectService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorStatusEffectService();
+
+	/** Ignored for anything but warriors and boxes, the first tick is dealt one TickInterval after applying */
+	void ApplyEffect(AActor* Target, const FWarriorStatusEffectSpec& Spec, AController* Instigator = nullptr);
+	void ApplyEffects(AActor* Target, const TArray<FWarriorStatusEffectSpec>& Specs, AController* Instigator = nullptr);
+
+	/** Drops every effect on Target and lifts its slow, when it dies or leaves play */
+	void ClearEffects(AActor* Target);
+
+	int32 GetNumEffects(EWarriorStatusEffect Type) const;
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Further applications of a type are ignored once it has this many active effects */
+	UPROPERTY(EditAnywhere, config, Category=StatusEffect)
+	int32 MaxEffectsPerType;
+
+	/** Ticks never come faster than this (in seconds), whatever the spec says */
+	UPROPERTY(EditAnywhere, config, Category=StatusEffect)
+	float MinTickInterval;
+
+private:
+	/** Active effects of one type, structure of arrays; the float arrays are padded to a multiple of 4 during the update only */
+	struct FEffectArrays
+	{
+		TArray<int32> TargetSlots;
+		TArray<float, TAlignedHeapAllocator<16>> Magnitudes;
+		TArray<float, TAlignedHeapAllocator<16>> Remaining;
+		TArray<float, TAlignedHeapAllocator<16>> TickIntervals;
+		TArray<float, TAlignedHeapAllocator<16>> TimeToTick;
+		/** Damage ticked by each effect this frame */
+		TArray<float, TAlignedHeapAllocator<16>> Ticked;
+
+		int32 Num() const { return TargetSlots.Num(); }
+		void Add(int32 TargetSlot, float Magnitude, float Duration, float TickInterval);
+		void RemoveAtSwap(int32 Index);
+	};
+
+	struct FTarget
+	{
+		TWeakObjectPtr<AActor> Actor;
+		/** Of the last effect applied, credited with the damage */
+		TWeakObjectPtr<AController> Instigator;
+		int32 NumEffects = 0;
+		/** Slow currently applied, the warrior's movement component scales its walk speed by it */
+		float AppliedSlow = 0.f;
+	};
+
+	/** Advances every effect of TypeEffects by DeltaTime and fills its Ticked array */
+	static void UpdateEffects(FEffectArrays& TypeEffects, float DeltaTime);
+
+	int32 FindOrAddTarget(AActor* Target);
+	void SetSlow(FTarget& Target, float Slow);
+	void ReleaseTarget(int32 Slot);
+
+	FEffectArrays Effects[(int32)EWarriorStatusEffect::Count];
+
+	/** Slots referenced by the effects, free slots are reused */
+	TArray<FTarget> Targets;
+	TArray<int32> FreeTargetSlots;
+	TMap<TWeakObjectPtr<AActor>, int32> TargetSlotsByActor;
+
+	/** Per target slot, rebuilt every frame */
+	TArray<float> PendingDamage;
+	TArray<float> StrongestSlow;
+};
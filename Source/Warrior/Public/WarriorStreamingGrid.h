@@ -0,0 +1,148 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorStreamingGrid.generated.h"
+
+class AArrow;
+class AWarriorCombatCharacter;
+class ULevelStreamingDynamic;
+
+/**
+ * Grid based level streaming for large battlefields.
+ * Place one in the persistent level: the map is split in NumCells square cells of CellSize starting
+ * at the actor location, each cell's terrain and props live in their own level (CellLevelFormat)
+ * which is streamed in around the players and out behind them.
+ * Combat actors follow the cells: targets are spawned once their cell is visible and removed with
+ * it, AI warriors standing in an unloaded cell are suspended, arrows flying into one are dropped.
+ */
+UCLASS(placeable)
+class WARRIOR_API AWarriorStreamingGrid : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorStreamingGrid();
+
+	/** Cell containing Location, may be outside of the grid */
+	FIntPoint GetCellAt(const FVector& Location) const;
+
+	/** World location of the minimum corner of a cell */
+	FVector GetCellOrigin(const FIntPoint& Cell) const;
+
+	/** True if the cell can host gameplay: visible, or outside of the streamed area */
+	bool IsCellReady(const FIntPoint& Cell) const;
+
+	/**
+	 * Spawns an actor relative to the origin of a cell, as soon as the cell is visible.
+	 * The actor is destroyed when the cell unloads and spawned again when it comes back.
+	 */
+	void SpawnInCell(TSubclassOf<AActor> ActorClass, const FIntPoint& Cell, const FTransform& RelativeTransform);
+
+	void RegisterWarrior(AWarriorCombatCharacter* Warrior);
+	void UnregisterWarrior(AWarriorCombatCharacter* Warrior);
+
+	/** Arrows are tracked while in flight to hand them over from cell to cell */
+	void RegisterArrow(AArrow* Arrow);
+
+	/** Prints streaming, hitch and memory stats to the log */
+	void DumpStats() const;
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Size of a cell side in unreal units */
+	UPROPERTY(EditAnywhere, Category=Streaming)
+	float CellSize;
+
+	/** Number of cells along X and Y */
+	UPROPERTY(EditAnywhere, Category=Streaming)
+	FIntPoint NumCells;
+
+	/** Long package name of a cell level, {X} and {Y} are replaced by the cell coordinates. Missing cells are treated as empty */
+	UPROPERTY(EditAnywhere, Category=Streaming)
+	FString CellLevelFormat;
+
+	/** Cells within this many cells of a player are loaded */
+	UPROPERTY(EditAnywhere, Category=Streaming)
+	int32 LoadRadius;
+
+	/** Cells further than this many cells from every player are unloaded, larger than LoadRadius to avoid thrashing on borders */
+	UPROPERTY(EditAnywhere, Category=Streaming)
+	int32 UnloadRadius;
+
+	/** Frames longer than this while a cell becomes visible count as streaming hitches */
+	UPROPERTY(EditAnywhere, Category=Streaming)
+	float HitchThresholdMs;
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	enum class ECellState : uint8
+	{
+		Unloaded,
+		Loading,
+		Visible,
+	};
+
+	struct FCellSpawn
+	{
+		TSubclassOf<AActor> ActorClass;
+		FTransform RelativeTransform;
+		/** Live actor, null while the cell is unloaded */
+		TWeakObjectPtr<AActor> Actor;
+	};
+
+	struct FCell
+	{
+		ECellState State = ECellState::Unloaded;
+		/** Null for cells without a level */
+		ULevelStreamingDynamic* Level = nullptr;
+		TArray<FCellSpawn> Spawns;
+	};
+
+	struct FTrackedArrow
+	{
+		TWeakObjectPtr<AArrow> Arrow;
+		FIntPoint Cell;
+	};
+
+	bool IsInGrid(const FIntPoint& Cell) const;
+
+	/** Cells wanted by the players this frame, within Radius cells */
+	void GatherCellsAroundPlayers(int32 Radius, TSet<FIntPoint>& OutCells) const;
+
+	void LoadCell(const FIntPoint& Coords, FCell& Cell);
+	void UnloadCell(const FIntPoint& Coords, FCell& Cell);
+	void OnCellVisible(const FIntPoint& Coords, FCell& Cell);
+
+	void UpdateWarriors();
+	void UpdateArrows();
+	void UpdateStats(float DeltaTime, bool bCellBecameVisible);
+
+	TMap<FIntPoint, FCell> Cells;
+
+	/** Level streaming objects are UObjects, keep them referenced while they are in use */
+	UPROPERTY(Transient)
+	TArray<ULevelStreamingDynamic*> CellLevels;
+
+	TArray<TWeakObjectPtr<AWarriorCombatCharacter>> Warriors;
+	TArray<FTrackedArrow> Arrows;
+
+	/** Frames since a cell last became visible, used to attribute hitches to streaming */
+	int32 FramesSinceCellVisible;
+
+	int32 NumCellLoads;
+	int32 NumCellUnloads;
+	int32 NumArrowHandoffs;
+	int32 NumArrowsDropped;
+	int32 NumStreamingFrames;
+	int32 NumStreamingHitches;
+	float MaxStreamingFrameMs;
+	float MaxFrameMs;
+	uint64 MinUsedPhysical;
+	uint64 MaxUsedPhysical;
+	float TimeToNextMemorySample;
+};
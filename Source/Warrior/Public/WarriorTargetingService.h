@@ -0,0 +1,130 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "WarriorWorldService.h"
+#include "WarriorTargetingService.generated.h"
+
+class AWarriorCombatCharacter;
+
+/**
+ * Picks a target for every registered warrior.
+ * Only MaxEvaluationsPerFrame warriors are evaluated each frame (round robin), the result is cached
+ * together with the time it was computed so callers can decide how stale a target they accept.
+ * Warriors are bucketed in a coarse grid, an evaluation only visits the cells within MaxTargetRange;
+ * MaxGridUpdatesPerFrame warriors are re-bucketed each frame, also round robin.
+ */
+UCLASS(config=Game, notplaceable)
+class WARRIOR_API AWarriorTargetingService : public AWarriorWorldService
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorTargetingService();
+
+	/** Adds a warrior to the round robin, it gets a target within a few frames */
+	void RegisterWarrior(AWarriorCombatCharacter* Warrior);
+
+	/** Removes a warrior, its cached target is discarded */
+	void UnregisterWarrior(AWarriorCombatCharacter* Warrior);
+
+	/**
+	 * Returns the cached target of Warrior.
+	 * @param MaxStaleness	Targets evaluated longer ago than this (in seconds) are ignored
+	 */
+	AActor* GetTarget(const AWarriorCombatCharacter* Warrior, float MaxStaleness) const;
+
+	/** Seconds since the target of Warrior was last evaluated, negative if never evaluated */
+	float GetTargetAge(const AWarriorCombatCharacter* Warrior) const;
+
+	/** Number of warriors taking part in target selection */
+	int32 GetNumRegistered() const { return Slots.Num(); }
+
+	virtual void Tick(float DeltaTime) override;
+
+	/** Number of warriors evaluated per frame, whatever the number of registered warriors */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	int32 MaxEvaluationsPerFrame;
+
+	/** Line of sight traces allowed per evaluation, best scored candidates are traced first */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	int32 MaxLineOfSightChecks;
+
+	/** Targets further than this are ignored */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	float MaxTargetRange;
+
+	/** Half angle of the view cone in degrees */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	float MaxTargetAngle;
+
+	/** Score weights, higher is more important */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	float DistanceWeight;
+
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	float AngleWeight;
+
+	/** Favors targets that already lost health */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	float HealthWeight;
+
+	/** Size of the grid cells, around MaxTargetRange keeps an evaluation to 4 to 9 cells */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	float GridCellSize;
+
+	/** Number of warriors moved to their current cell per frame */
+	UPROPERTY(EditAnywhere, config, Category=Targeting)
+	int32 MaxGridUpdatesPerFrame;
+
+private:
+	struct FTargetSlot
+	{
+		TWeakObjectPtr<AWarriorCombatCharacter> Warrior;
+		TWeakObjectPtr<AActor> Target;
+
+		/** World time of the last evaluation, negative if never evaluated */
+		float LastEvaluatedTime;
+
+		/** Grid cell the slot is listed in */
+		FIntPoint Cell;
+	};
+
+	struct FTargetCandidate
+	{
+		AWarriorCombatCharacter* Warrior;
+		float Score;
+	};
+
+	/** Runs the target selection for one slot */
+	void EvaluateSlot(FTargetSlot& Slot, float Now);
+
+	bool HasLineOfSight(const AWarriorCombatCharacter* From, const AActor* To) const;
+
+	static bool IsValidTarget(const AWarriorCombatCharacter* Warrior);
+
+	FIntPoint GetCellAt(const FVector& Location) const;
+
+	/** Lists SlotIndex in Cell, or takes it out of its cell */
+	void AddToCell(int32 SlotIndex, const FIntPoint& Cell);
+	void RemoveFromCell(int32 SlotIndex);
+
+	TArray<FTargetSlot> Slots;
+
+	/** Slot index per warrior, kept in sync with the swap removals in UnregisterWarrior */
+	TMap<const AWarriorCombatCharacter*, int32> SlotIndices;
+
+	/** Next slot to evaluate */
+	int32 Cursor;
+
+	/** Slot indices per grid cell */
+	TMap<FIntPoint, TArray<int32>> Cells;
+
+	/** Next slot to re-bucket */
+	int32 GridCursor;
+
+	/** Reused between evaluations to avoid allocations */
+	TArray<FTargetCandidate> Candidates;
+	TArray<int32> NearbySlots;
+};
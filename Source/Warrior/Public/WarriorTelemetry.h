@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Templates/Atomic.h"
+
+class AActor;
+
+namespace WarriorTelemetry { class FWriter; }
+
+/** Combat events written to the telemetry stream, values are stored in the files so never reorder */
+enum class EWarriorTelemetryEvent : uint8
+{
+	None = 0,
+	/** Attack pressed, Value is the combo count */
+	AttackPressed = 1,
+	/** Arrow spawned, Target is the arrow */
+	ArrowSpawned = 2,
+	/** Arrow contact, Source is the arrow */
+	ArrowHit = 3,
+	/** Damage taken, Source is the damage causer, Value the damage */
+	DamageApplied = 4,
+	/** Health reached zero, Value is the final health */
+	Death = 5,
+};
+
+/** One event, fixed size so the file can be indexed directly */
+struct FWarriorTelemetryRecord
+{
+	/** FPlatformTime::Cycles64 when the event happened */
+	uint64 Cycles;
+	uint32 Frame;
+	uint8 Type;
+	/** Bit 0: source team, bit 1: target team */
+	uint8 Flags;
+	uint16 Reserved;
+	uint32 SourceId;
+	uint32 TargetId;
+	float Value;
+	float X;
+	float Y;
+	float Z;
+};
+static_assert(sizeof(FWarriorTelemetryRecord) == 40, "Telemetry record layout is part of the file format");
+
+/** Start of every telemetry file, followed by NumRecords records */
+struct FWarriorTelemetryFileHeader
+{
+	static const uint32 ExpectedMagic = 0x4D4C5457; // 'WTLM'
+	static const uint16 CurrentVersion = 1;
+
+	uint32 Magic;
+	uint16 Version;
+	uint16 RecordSize;
+	double SecondsPerCycle;
+	uint64 StartCycles;
+	/** Records committed by the writer, anything past them is garbage */
+	uint64 NumRecords;
+	/** Records lost because a thread buffer was full */
+	uint64 NumDropped;
+	/** Record fields as "Name:type" pairs, for tools that don't link against this header */
+	ANSICHAR Schema[216];
+};
+static_assert(sizeof(FWarriorTelemetryFileHeader) == 256, "Telemetry header layout is part of the file format");
+
+/**
+ * Low overhead recorder for combat events.
+ * Record only copies the event into a lock free buffer owned by the calling thread; a writer
+ * thread drains the buffers into an append only memory mapped file. Start with -WarriorTelemetry[=File]
+ * or the Warrior.Telemetry.Start console command, convert with -run=WarriorTelemetryToCsv.
+ */
+class WARRIOR_API FWarriorTelemetry
+{
+public:
+	/** Opens the file and starts the writer thread, Path defaults to Saved/Profiling/ */
+	static bool Start(const FString& Path = FString());
+
+	/** Flushes every buffer, trims the file and stops the writer thread */
+	static void Stop();
+
+	static bool IsRecording() { return bRecording.Load(EMemoryOrder::Relaxed); }
+
+	static void Record(EWarriorTelemetryEvent Type, const AActor* Source, const AActor* Target, float Value, const FVector& Location)
+	{
+		if (bRecording.Load(EMemoryOrder::Relaxed))
+		{
+			RecordEvent(Type, Source, Target, Value, Location);
+		}
+	}
+
+	static const TCHAR* GetEventName(uint8 Type);
+
+private:
+	friend class WarriorTelemetry::FWriter;
+
+	static void RecordEvent(EWarriorTelemetryEvent Type, const AActor* Source, const AActor* Target, float Value, const FVector& Location);
+
+	/** Also cleared by the writer thread when the file can't grow */
+	static TAtomic<bool> bRecording;
+};
@@ -0,0 +1,23 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Commandlets/Commandlet.h"
+#include "WarriorTelemetryToCsvCommandlet.generated.h"
+
+/**
+ * Converts a combat telemetry file to CSV.
+ *
+ * Usage: -run=WarriorTelemetryToCsv -In=Saved/Profiling/WarriorTelemetry-xxx.bin [-Out=events.csv]
+ */
+UCLASS()
+class UWarriorTelemetryToCsvCommandlet : public UCommandlet
+{
+	GENERATED_BODY()
+
+public:
+	UWarriorTelemetryToCsvCommandlet();
+
+	virtual int32 Main(const FString& Params) override;
+};
@@ -0,0 +1,45 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Info.h"
+#include "Engine/World.h"
+#include "Engine/Engine.h"
+#include "WarriorWorldService.generated.h"
+
+/**
+ * Base class for the per-world gameplay services (targeting, navigation, ...).
+ * A service is a hidden, non replicated actor that is spawned on demand the first time
+ * somebody asks for it, so levels don't need to place anything by hand. Services that need
+ * per level settings can also be placed, Get then returns the placed one.
+ */
+UCLASS(abstract)
+class WARRIOR_API AWarriorWorldService : public AInfo
+{
+	GENERATED_BODY()
+
+public:
+	AWarriorWorldService();
+
+	/**
+	 * Returns the service of the given class living in the world of WorldContextObject.
+	 * @param bCreateIfMissing	Spawns the service if there is none yet (game worlds only)
+	 */
+	template<class T>
+	static T* Get(const UObject* WorldContextObject, bool bCreateIfMissing = true)
+	{
+		return Cast<T>(GetService(WorldContextObject, T::StaticClass(), bCreateIfMissing));
+	}
+
+protected:
+	virtual void BeginPlay() override;
+
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	static AWarriorWorldService* GetService(const UObject* WorldContextObject, UClass* ServiceClass, bool bCreateIfMissing);
+
+	/** Services per world, looked up by class */
+	static TMap<TPair<TWeakObjectPtr<UWorld>, UClass*>, TWeakObjectPtr<AWarriorWorldService>> Services;
+};
@@ -2,6 +2,74 @@
 
 #include "Warrior.h"
 #include "Modules/ModuleManager.h"
+#include "WarriorBotDriver.h"
+#include "WarriorLoadStats.h"
+#include "WarriorTelemetry.h"
+#include "WarriorMemoryTracker.h"
+#include "WarriorLatencyTrace.h"
+#include "WarriorReplicationGraph.h"
+#include "Engine/NetDriver.h"
+#include "Engine/ReplicationDriver.h"
+#include "Misc/CommandLine.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, Warrior, "Warrior" );
- 
\ No newline at end of file
+DEFINE_LOG_CATEGORY(LogWarrior);
+
+class FWarriorModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		FWarriorMemoryTracker::RegisterLLMTags();
+
+		BotDriver = FWarriorBotDriver::CreateFromCommandLine();
+		LoadStats = FWarriorServerLoadStats::CreateFromCommandLine();
+
+		FString TelemetryPath;
+		if (FParse::Value(FCommandLine::Get(), TEXT("WarriorTelemetry="), TelemetryPath) || FParse::Param(FCommandLine::Get(), TEXT("WarriorTelemetry")))
+		{
+			FWarriorTelemetry::Start(TelemetryPath);
+		}
+
+		FString LatencyPath;
+		if (FParse::Value(FCommandLine::Get(), TEXT("WarriorLatencyTrace="), LatencyPath) || FParse::Param(FCommandLine::Get(), TEXT("WarriorLatencyTrace")))
+		{
+			FWarriorLatencyTrace::Start(LatencyPath);
+		}
+
+		FString MemoryCsvPath;
+		if (FParse::Value(FCommandLine::Get(), TEXT("WarriorMemoryCsv="), MemoryCsvPath) || FParse::Param(FCommandLine::Get(), TEXT("WarriorMemoryCsv")))
+		{
+			float MemoryInterval = 5.f;
+			FParse::Value(FCommandLine::Get(), TEXT("WarriorMemoryInterval="), MemoryInterval);
+			FWarriorMemoryTracker::StartCsv(MemoryCsvPath, MemoryInterval);
+		}
+
+		// -WarriorNoRepGraph falls back to the engine's relevancy, to compare server replication cost
+		if (!FParse::Param(FCommandLine::Get(), TEXT("WarriorNoRepGraph")))
+		{
+			UReplicationDriver::CreateReplicationDriverDelegate().BindLambda([](UNetDriver* ForNetDriver, const FURL& URL, UWorld* World) -> UReplicationDriver*
+			{
+				return ForNetDriver->NetDriverName == NAME_GameNetDriver ? NewObject<UWarriorReplicationGraph>(GetTransientPackage()) : nullptr;
+			});
+		}
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FWarriorTelemetry::Stop();
+		FWarriorMemoryTracker::StopCsv();
+		FWarriorLatencyTrace::Stop();
+		UReplicationDriver::CreateReplicationDriverDelegate().Unbind();
+		BotDriver.Reset();
+		LoadStats.Reset();
+	}
+
+private:
+	/** Drives the local players of a headless bot client (-WarriorBots=N) */
+	TUniquePtr<FWarriorBotDriver> BotDriver;
+
+	/** Server capacity report (-WarriorLoadTest) */
+	TUniquePtr<FWarriorServerLoadStats> LoadStats;
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FWarriorModule, Warrior, "Warrior" );
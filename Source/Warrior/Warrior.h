@@ -3,3 +3,7 @@
 #pragma once
 
 #include "CoreMinimal.h"
+
+DECLARE_LOG_CATEGORY_EXTERN(LogWarrior, Log, All);
+
+DECLARE_STATS_GROUP(TEXT("Warrior"), STATGROUP_Warrior, STATCAT_Advanced);
@@ -3,45 +3,25 @@
 #include "WarriorCharacter.h"
 #include "HeadMountedDisplayFunctionLibrary.h"
 #include "Camera/CameraComponent.h"
-#include "Components/CapsuleComponent.h"
 #include "Components/InputComponent.h"
-#include "GameFramework/CharacterMovementComponent.h"
 #include "GameFramework/Controller.h"
 #include "GameFramework/SpringArmComponent.h"
-#include "DrawDebugHelpers.h"
 #include "Runtime/Engine/Classes/Components/SceneComponent.h"
-#include "Arrow.h"
-#include "BoxActor.h"
-#include "Components/SphereComponent.h"
+#include "WarriorMemoryTracker.h"
+#include "WarriorLatencyTrace.h"
 
 //////////////////////////////////////////////////////////////////////////
 // AWarriorCharacter
 
-AWarriorCharacter::AWarriorCharacter()
+AWarriorCharacter::AWarriorCharacter(const FObjectInitializer& ObjectInitializer)
+	: Super(ObjectInitializer)
 {
-	// Set size for collision capsule
-	GetCapsuleComponent()->InitCapsuleSize(42.f, 96.0f);
-	CollisionComp = CreateDefaultSubobject<USphereComponent>(TEXT("SphereComp"));
-	CollisionComp->SetupAttachment(RootComponent);
-
-
+	WARRIOR_LLM_SCOPE(Warriors);
 
 	// set our turn rates for input
 	BaseTurnRate = 45.f;
 	BaseLookUpRate = 45.f;
 
-	// Don't rotate when the controller rotates. Let that just affect the camera.
-	bUseControllerRotationPitch = false;
-	bUseControllerRotationYaw = false;
-	bUseControllerRotationRoll = false;
-
-	// Configure character movement
-	GetCharacterMovement()->bOrientRotationToMovement = true; // Character moves in the direction of input...	
-	GetCharacterMovement()->RotationRate = FRotator(0.0f, 540.0f, 0.0f); // ...at this rotation rate
-	GetCharacterMovement()->JumpZVelocity = 600.f;
-	GetCharacterMovement()->AirControl = 0.2f;
-
-	
 	// Create a camera boom (pulls in towards the player if there is a collision)
 	CameraBoom = CreateDefaultSubobject<USpringArmComponent>(TEXT("CameraBoom"));
 	CameraBoom->SetupAttachment(RootComponent);
@@ -53,36 +33,6 @@ AWarriorCharacter::AWarriorCharacter()
 	FollowCamera = CreateDefaultSubobject<UCameraComponent>(TEXT("FollowCamera"));
 	FollowCamera->SetupAttachment(CameraBoom, USpringArmComponent::SocketName); // Attach the camera to the end of the boom and let the boom adjust to match the controller orientation
 	FollowCamera->bUsePawnControlRotation = false; // Camera does not rotate relative to arm
-	
-	// Note: The skeletal mesh and anim blueprint references on the Mesh component (inherited from Character) 
-	// are set in the derived blueprint asset named MyCharacter (to avoid direct content references in C++)
-	
-	AttackCount = 0;
-
-	//Init health
-
-	DefaultHealth = 100;
-	Health = DefaultHealth;
-	HealthPercentage = 1.0;
-
-
-	//Detection Component
-	
-	// Use a sphere as a simple collision representation
-	//RootComponent = GetCapsuleComponent();
-	
-	CollisionComp->InitSphereRadius(300.0f);
-	//CollisionComp->BodyInstance.SetCollisionProfileName("Detection");
-	CollisionComp->OnComponentBeginOverlap.AddDynamic(this, &AWarriorCharacter::OnHit);		// set up a notification for when this component hits something blocking
-
-	// Players can't walk on it
-	//CollisionComp->SetWalkableSlopeOverride(FWalkableSlopeOverride(WalkableSlope_Unwalkable, 0.f));
-	//CollisionComp->CanCharacterStepUpOn = ECB_No;
-
-	AttackOnOff = false;
-
-	
-	
 }
 
 
@@ -115,7 +65,7 @@ void AWarriorCharacter::SetupPlayerInputComponent(class UInputComponent* PlayerI
 	// VR headset functionality
 	PlayerInputComponent->BindAction("ResetVR", IE_Pressed, this, &AWarriorCharacter::OnResetVR);
 
-	PlayerInputComponent->BindAction("Attack", IE_Pressed, this, &AWarriorCharacter::Attack);
+	PlayerInputComponent->BindAction("Attack", IE_Pressed, this, &AWarriorCharacter::OnAttackInput);
 }
 
 
@@ -175,306 +125,26 @@ void AWarriorCharacter::MoveRight(float Value)
 	}
 }
 
-int i;
-// Called when the game starts or when spawned
-void AWarriorCharacter::BeginPlay()
+void AWarriorCharacter::OnAttackInput()
 {
-	Super::BeginPlay();
-
-	i = 0;
-	if (Team == true)
-	{
-		FVector BoxPos = FVector(-1000, 1000, 200);
-		UWorld* const World = GetWorld();
-		const FRotator SpawnRotation = GetActorRotation();
-		FActorSpawnParameters ActorSpawnParams;
-		GetWorld()->SpawnActor<ABoxActor>(Box, BoxPos, SpawnRotation, ActorSpawnParams);
-	}
+	LatencyTraceId = FWarriorLatencyTrace::BeginTrace();
+	Attack();
 }
 
-
+void AWarriorCharacter::OnAttackStarted()
+{
+	// Input stays off until the combo is reset, see Tick
+	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
+	this->DisableInput(PlayerController);
+}
 
 void AWarriorCharacter::Tick(float DeltaTime)
 {
 	Super::Tick(DeltaTime);
 
-	// get first player pawn location
-	//FVector MyCharacter = GetWorld()->GetFirstPlayerController()->GetPawn()->GetActorLocation();
-	PlayerPosition = this->GetActorLocation();
-	// screen log player location
-	//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Blue, FString::Printf(TEXT("Player Location: %s"), *NewChar.ToString()));	
-	//bool check = IsMoving();
-
-	
-	
-	if (i == 5)
-	{
-		if (IsMoving() == true)
-		{
-			AttackCount = 0;
-
-			GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::White, TEXT("Reset the attack count"));
-		}
-	}
-
-	i += 1;
-
-	if (i > 11)
-	{
-		i = 1;
-	}
-	
-
 	if (IsAttacking == false)
 	{
 		APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
 		this->EnableInput(PlayerController);
 	}
-
-	/*
-	if (IsMoving() == true )
-	{
-		AttackCount = 0;
-	}
-	*/
 }
-
-void AWarriorCharacter::Attack()
-{
-	APlayerController* PlayerController = GetWorld()->GetFirstPlayerController();
-	this->DisableInput(PlayerController);
-
-	if (GEngine)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("Attack Pressed"));
-		//IsAttacking = true;
-	}
-
-	IsAttacking = true;
-	AttackCount += 1;
-	GoToSwitch();
-
-	/*
-	if (IsAttacking == true)
-	{
-		SaveAttack = true;
-	}
-	else
-	{
-		IsAttacking = true;
-		GoToSwitch();
-	}
-	*/
-	/*Line Trace*/
-
-	FHitResult OutHit;
-
-
-	FVector Initpos = this->GetActorLocation();
-	FVector TempVector = this->GetActorForwardVector();
-	FVector Finalpos = ((TempVector *100.f + Initpos));
-	Finalpos = Finalpos + FVector(0, 0, 50);
-
-
-	//FVector Start = this->GetActorLocation();
-	
-
-	// alternatively you can get the camera location
-	// FVector Start = FirstPersonCameraComponent->GetComponentLocation();
-
-	FVector Start = Finalpos;
-	FVector ForwardVector = this->GetActorForwardVector();
-	FVector End = ((ForwardVector * 2000.f) + Start);
-	FCollisionQueryParams CollisionParams;
-
-	//DrawDebugLine(GetWorld(), Start, End, FColor::Green, false, 5, 0, 1);
-
-	if(GetWorld()->LineTraceSingleByChannel(OutHit, Start, End, ECC_PhysicsBody, CollisionParams))
-	{
-		if(OutHit.bBlockingHit)
-		{
-            if (GEngine) {
-				/*
-			    GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Red, FString::Printf(TEXT("You are hitting: %s"), *OutHit.GetActor()->GetName()));
-			    GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Red, FString::Printf(TEXT("Impact Point: %s"), *OutHit.ImpactPoint.ToString()));
-                GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Red, FString::Printf(TEXT("Normal Point: %s"), *OutHit.ImpactNormal.ToString()));
-				*/
-            }
-		}
-	}
-
-	//projectile
-	//UWorld* const World = GetWorld();
-
-	//const FRotator SpawnRotation = GetActorRotation();
-	//Set Spawn Collision Handling Override
-	//FActorSpawnParameters ActorSpawnParams;
-	//ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-
-	//FVector SpawnLocation = Start;
-
-	//World->SpawnActor<AArrow>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
-
-	//SpawnProjectileArrow(Start);
-}
-
-void AWarriorCharacter::SpawnProjectileArrow()
-{
-
-	FVector Initpos = this->GetActorLocation();
-	FVector TempVector = this->GetActorForwardVector();
-	FVector Finalpos = ((TempVector *100.f + Initpos));
-	Finalpos = Finalpos + FVector(0, 0, 50);
-
-	FVector Start = Finalpos;
-
-	//projectile
-	UWorld* const World = GetWorld();
-
-	const FRotator SpawnRotation = GetActorRotation();
-	//Set Spawn Collision Handling Override
-	FActorSpawnParameters ActorSpawnParams;
-	//ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-
-	FVector SpawnLocation = Start;
-
-	World->SpawnActor<AArrow>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
-
-	if (AttackCount == 3  && AttackOnOff == true)
-	{
-		count=2;
-		GetWorld()->GetTimerManager().SetTimer(Delay, this, &AWarriorCharacter::TimerEnd, 0.2f, false);
-	}
-
-}
-
-void AWarriorCharacter::TimerEnd()
-{
-	FVector Initpos = this->GetActorLocation();
-	FVector TempVector = this->GetActorForwardVector();
-	FVector Finalpos = ((TempVector *100.f + Initpos));
-	Finalpos = Finalpos + FVector(0, 0, 50);
-
-	FVector Start = Finalpos;
-
-	//projectile
-	UWorld* const World = GetWorld();
-
-	const FRotator SpawnRotation = GetActorRotation();
-	//Set Spawn Collision Handling Override
-	FActorSpawnParameters ActorSpawnParams;
-	//ActorSpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AdjustIfPossibleButDontSpawnIfColliding;
-
-	FVector SpawnLocation = Start;
-	if (count != 0)
-	{
-		World->SpawnActor<AArrow>(ProjectileClass, SpawnLocation, SpawnRotation, ActorSpawnParams);
-		count -= 1;
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Magenta, FString::Printf(TEXT("Delay Test")));
-		GetWorld()->GetTimerManager().SetTimer(Delay, this, &AWarriorCharacter::TimerEnd, 0.2f, false);
-		AttackOnOff = false;
-	}
-	
-}
-
-void AWarriorCharacter::ComboAttackSave()
-{
-	if (SaveAttack == true)
-	{
-		SaveAttack = false;
-		GoToSwitch();
-	}
-}
-
-void AWarriorCharacter::GoToSwitch()
-{
-	//UAnimInstance* AnimInstance = GetMesh()->GetAnimInstance();
-	
-	switch (AttackCount)
-	{
-	case 1:
-		//AttackCount = 1;
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Attack 1")));
-		//Animation 1
-		
-		break;
-	case 2:
-		//AttackCount = 2;
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Attack 2")));
-		//Animation 1
-		
-		break;
-	case 3:
-		
-		//AttackCount = 0;
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Attack 3")));
-		AttackOnOff = true;
-
-		//ComboAnim
-		
-		
-		break;
-	default:
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Error")));
-
-	}
-}
-
-void AWarriorCharacter::ResetCombo()
-{
-	IsAttacking = false;
-	//AttackCount = 0;
-	SaveAttack = false;
-}
-
-bool AWarriorCharacter::IsMoving()
-{
-	//if (this->GetVelocity.SizeSquared() < 5)
-	if(GetCharacterMovement()->Velocity.Size() == 0)
-	{
-		//character is not moving
-		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Red, FString::Printf(TEXT("Player not moving")));
-		return false;
-	}
-	else
-	{
-		//Character is moving
-		//GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, FString::Printf(TEXT("Player Moving")));
-		return true;
-
-	}
-}
-
-
-float AWarriorCharacter::TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, class AActor* DamageCauser)
-{
-	Health -= DamageAmount;
-	GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::Green, TEXT("TakeDamage Function Called in WarriorCharacter, Damage recieved"));
-
-	if (Health <= 0)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 5.f, FColor::White, TEXT("Character Destroyed"));
-		Destroy(this);
-	}
-	return Health;
-}
-
-void AWarriorCharacter::OnHit(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
-{
-	//GEngine->AddOnScreenDebugMessage(-1, 10.f, FColor::Yellow, FString::Printf(TEXT("Object detected : %s"), *OtherComp->GetName()));
-	AWarriorCharacter* WarriorChar = Cast<AWarriorCharacter>(OtherActor);
-	if (!WarriorChar) return;
-	if ((OtherActor!=this) && OtherActor == WarriorChar && OtherComp != WarriorChar->CollisionComp && !Team)
-	{
-		GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Yellow, FString::Printf(TEXT("Object detected is a WarriorCharacter: %s"), *OtherActor->GetName()));
-
-		// Item is a weapon
-		//GEngine->AddOnScreenDebugMessage(-1, 1.0f, FColor::Yellow, FString::Printf(TEXT("Object detected is a WarriorCharacter: %s"), *OtherActor->GetName()));
-
-	}
-}
-
-bool AWarriorCharacter::ReturnTeam()
-{
-	return true;
-}
\ No newline at end of file
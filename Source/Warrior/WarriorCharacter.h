@@ -3,14 +3,18 @@
 #pragma once
 
 #include "CoreMinimal.h"
-#include "GameFramework/Character.h"
+#include "WarriorCombatCharacter.h"
 #include "WarriorCharacter.generated.h"
 
+/** Player warrior: the combat core plus the follow camera and the input bindings */
 UCLASS(config=Game)
-class AWarriorCharacter : public ACharacter
+class AWarriorCharacter : public AWarriorCombatCharacter
 {
 	GENERATED_BODY()
 
+	/** Bot clients drive warriors through the same entry points as the input bindings */
+	friend class FWarriorBotDriver;
+
 		
 	
 
@@ -22,7 +26,7 @@ class AWarriorCharacter : public ACharacter
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = Camera, meta = (AllowPrivateAccess = "true"))
 	class UCameraComponent* FollowCamera;
 public:
-	AWarriorCharacter();
+	AWarriorCharacter(const FObjectInitializer& ObjectInitializer);
 
 	/** Base turn rate, in deg/sec. Other scaling may affect final turn rate. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category=Camera)
@@ -61,12 +65,15 @@ protected:
 	/** Handler for when a touch input stops. */
 	void TouchStopped(ETouchIndex::Type FingerIndex, FVector Location);
 
+	/** Attack binding, starts the latency trace of the attack */
+	void OnAttackInput();
+
 protected:
 	// APawn interface
 	virtual void SetupPlayerInputComponent(class UInputComponent* PlayerInputComponent) override;
 	// End of APawn interface
 
-	virtual void BeginPlay() override;
+	virtual void OnAttackStarted() override;
 
 public:
 	/** Returns CameraBoom subobject **/
@@ -74,42 +81,6 @@ public:
 	/** Returns FollowCamera subobject **/
 	FORCEINLINE class UCameraComponent* GetFollowCamera() const { return FollowCamera; }
 
-	
-	UFUNCTION(BlueprintCallable)
-	void Attack();
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-	bool IsAttacking;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-	bool SaveAttack;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-	int AttackCount;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-		FVector PlayerPosition;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-		FVector AttackPosition;
-
-	UFUNCTION(BlueprintCallable)
-	void ComboAttackSave();
-
-	UFUNCTION(BlueprintCallable)
-	void ResetCombo();
-
-	UFUNCTION(BlueprintCallable)
-	void GoToSwitch();
-
-	UFUNCTION(BlueprintCallable)
-		bool IsMoving();
-
-	
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-		float offset;
-	
-
 	virtual void Tick(float DeltaTime) override;
 
 
@@ -123,63 +94,4 @@ public:
 	/** Location on VR gun mesh where projectiles should spawn. */
 	UPROPERTY(VisibleDefaultsOnly, Category = Mesh)
 	class USceneComponent* VR_MuzzleLocation;
-
-	
-	/** Projectile class to spawn */
-	UPROPERTY(EditDefaultsOnly, Category=Projectile)
-	TSubclassOf<class AArrow> ProjectileClass;
-
-	UFUNCTION(BlueprintCallable)
-	void SpawnProjectileArrow();
-
-	//Box Actor for health
-
-	UPROPERTY(EditAnywhere, Category= Box)
-	TSubclassOf<class ABoxActor> Box;
-
-	//Health properties
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-		float DefaultHealth;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-		float Health;
-
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite)
-		float HealthPercentage;
-
-	virtual float TakeDamage(float DamageAmount, struct FDamageEvent const& DamageEvent, class AController* EventInstigator, class AActor* DamageCauser);
-
-
-	//Detection properties
-
-	/** Sphere collision component */
-	UPROPERTY(VisibleAnywhere, BlueprintReadWrite, Category=Detectotherobjects)
-	class USphereComponent* CollisionComp;
-	
-	/** called when projectile hits something */
-	
-	UFUNCTION()
-	void OnHit(class UPrimitiveComponent* OverlappedComp, class AActor* OtherActor, class UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
-	
-	//team
-	UPROPERTY(EditAnywhere, BlueprintReadWrite)
-		bool Team;
-
-	UFUNCTION(BlueprintCallable)
-		bool ReturnTeam();
-
-	//delay
-
-	UPROPERTY(EditAnywhere)
-		FTimerHandle Delay;
-
-	UFUNCTION(BlueprintCallable)
-		void TimerEnd();
-
-	UPROPERTY(EditAnywhere)
-		int count;
-
-	UPROPERTY(EditAnywhere)
-		bool AttackOnOff;
-};
\ No newline at end of file
+};
@@ -2,7 +2,11 @@
 
 #include "WarriorGameMode.h"
 #include "WarriorCharacter.h"
+#include "WarriorArenaManager.h"
+#include "WarriorPawnPool.h"
 #include "UObject/ConstructorHelpers.h"
+#include "GameFramework/GameSession.h"
+#include "Misc/CommandLine.h"
 
 AWarriorGameMode::AWarriorGameMode()
 {
@@ -12,4 +16,105 @@ AWarriorGameMode::AWarriorGameMode()
 	{
 		DefaultPawnClass = PlayerPawnBPClass.Class;
 	}
+
+	NumArenas = 0;
+}
+
+void AWarriorGameMode::InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage)
+{
+	Super::InitGame(MapName, Options, ErrorMessage);
+
+	// Bot clients (-WarriorBots) put all their players behind one connection as split screen players
+	if (GameSession && FParse::Param(FCommandLine::Get(), TEXT("WarriorLoadTest")))
+	{
+		GameSession->MaxSplitscreensPerConnection = 64;
+	}
+
+	FParse::Value(FCommandLine::Get(), TEXT("WarriorArenas="), NumArenas);
+}
+
+void AWarriorGameMode::StartPlay()
+{
+	if (NumArenas > 0)
+	{
+		AWarriorWorldService::Get<AWarriorArenaManager>(this)->StartArenas(NumArenas);
+	}
+
+	Super::StartPlay();
+}
+
+void AWarriorGameMode::PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage)
+{
+	Super::PreLogin(Options, Address, UniqueId, ErrorMessage);
+
+	AWarriorArenaManager* Arenas = AWarriorWorldService::Get<AWarriorArenaManager>(this, false);
+	if (ErrorMessage.IsEmpty() && Arenas && !Arenas->HasFreeSlot())
+	{
+		ErrorMessage = TEXT("All arenas are full");
+	}
+}
+
+void AWarriorGameMode::HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer)
+{
+	if (AWarriorArenaManager* Arenas = AWarriorWorldService::Get<AWarriorArenaManager>(this, false))
+	{
+		const int32 ArenaIndex = Arenas->AssignPlayer(NewPlayer);
+		if (ArenaIndex == INDEX_NONE)
+		{
+			// Split screen players of an accepted connection, or players who joined at the same time, don't go through PreLogin's check
+			UE_LOG(LogWarrior, Warning, TEXT("Arenas: no room for %s, every arena is full"), *GetNameSafe(NewPlayer));
+			if (GameSession)
+			{
+				GameSession->KickPlayer(NewPlayer, FText::FromString(TEXT("All arenas are full")));
+			}
+			return;
+		}
+
+		// The arena restarts its players when it has loaded
+		if (!Arenas->IsArenaReady(ArenaIndex))
+		{
+			return;
+		}
+	}
+
+	Super::HandleStartingNewPlayer_Implementation(NewPlayer);
+}
+
+AActor* AWarriorGameMode::ChoosePlayerStart_Implementation(AController* Player)
+{
+	if (AWarriorArenaManager* Arenas = AWarriorWorldService::Get<AWarriorArenaManager>(this, false))
+	{
+		if (AActor* Start = Arenas->ChoosePlayerStart(Player))
+		{
+			return Start;
+		}
+	}
+
+	return Super::ChoosePlayerStart_Implementation(Player);
 }
+
+APawn* AWarriorGameMode::SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform)
+{
+	UClass* PawnClass = GetDefaultPawnClassForController(NewPlayer);
+	AWarriorPawnPool* Pool = AWarriorWorldService::Get<AWarriorPawnPool>(this, false);
+	if (Pool && PawnClass && PawnClass->IsChildOf<AWarriorCombatCharacter>())
+	{
+		// A player side warrior, RestartPlayer possesses it
+		if (APawn* Pawn = Pool->Acquire(PawnClass, false, SpawnTransform, nullptr, false))
+		{
+			return Pawn;
+		}
+	}
+
+	return Super::SpawnDefaultPawnAtTransform_Implementation(NewPlayer, SpawnTransform);
+}
+
+void AWarriorGameMode::Logout(AController* Exiting)
+{
+	if (AWarriorArenaManager* Arenas = AWarriorWorldService::Get<AWarriorArenaManager>(this, false))
+	{
+		Arenas->RemovePlayer(Exiting);
+	}
+
+	Super::Logout(Exiting);
+}
\ No newline at end of file
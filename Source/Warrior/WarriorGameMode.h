@@ -13,6 +13,27 @@ class AWarriorGameMode : public AGameModeBase
 
 public:
 	AWarriorGameMode();
+
+	virtual void InitGame(const FString& MapName, const FString& Options, FString& ErrorMessage) override;
+
+	virtual void StartPlay() override;
+
+	/** With arenas, connections are refused once every arena is full */
+	virtual void PreLogin(const FString& Options, const FString& Address, const FUniqueNetIdRepl& UniqueId, FString& ErrorMessage) override;
+
+	/** With arenas, players spawn once their arena is loaded and at its player starts */
+	virtual void HandleStartingNewPlayer_Implementation(APlayerController* NewPlayer) override;
+
+	virtual AActor* ChoosePlayerStart_Implementation(AController* Player) override;
+
+	/** Player warriors come out of the pawn pool when it has one */
+	virtual APawn* SpawnDefaultPawnAtTransform_Implementation(AController* NewPlayer, const FTransform& SpawnTransform) override;
+
+	virtual void Logout(AController* Exiting) override;
+
+private:
+	/** Arena instances hosted by this server (-WarriorArenas=N), 0 for a single match on the map itself */
+	int32 NumArenas;
 };
 
 